@@ -26,13 +26,14 @@ void handler(int sig) {
  **********************************/
 int main(int argc, char *argv[]) {
 	//signal(SIGSEGV, handler);
-	if ( argc != ARGS_COUNT ) {
+	if ( argc < ARGS_COUNT ) {
 		cout<<"Configuration (i.e., *.conf) file File Required"<<endl;
 		return FAILURE;
 	}
 
-	// Create a new application object
-	Application *app = new Application(argv[1]);
+	// Create a new application object, any KEY=value arguments after the
+	// config file override its parameters
+	Application *app = new Application(argv[1], argc - ARGS_COUNT, argv + ARGS_COUNT);
 	// Call the run function
 	app->run();
 	// When done delete the application object
@@ -44,35 +45,137 @@ int main(int argc, char *argv[]) {
 /**
  * Constructor of the Application class
  */
-Application::Application(char *infile) {
+Application::Application(char *infile, int nargs, char *args[]) {
 	int i;
 	par = new Params();
-	srand (time(NULL));
 	par->setparams(infile);
+	for ( i = 0; i < nargs; i++ ) {
+		if ( !par->setarg(args[i]) ) {
+			fprintf(stderr, "Unknown parameter %s\n", args[i]);
+		}
+	}
+	// Every random choice of the run follows from the seed, which the profile
+	// reports so that a clock seeded run can be repeated
+	if ( par->SEED == 0 ) {
+		par->SEED = (unsigned int)chrono::system_clock::now().time_since_epoch().count() | 1;
+	}
+	traceVerbosity() = par->VERBOSITY;
+	if ( !par->PROFILE.empty() ) {
+		Profiler::get().enable(par->THREADS);
+	}
+	exec = new TickExecutor(par->THREADS);
 	log = new Log(par);
 	en = new EmulNet(par);
+	// After EmulNet, which takes the seed of a replayed trace
+	rng.seed(par->SEED, RNG_STREAM_FAIL);
 	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
+	wakeAt.assign(par->EN_GPSZ, -1);
+	nodeRuns = 0;
 
 	/*
 	 * Init all nodes
 	 */
 	for( i = 0; i < par->EN_GPSZ; i++ ) {
-		Member *memberNode = new Member;
-		memberNode->inited = false;
-		Address *addressOfMemberNode = new Address();
-		Address joinaddr;
-		joinaddr = getjoinaddr();
-		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
-		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
-		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
-		delete addressOfMemberNode;
+		mp1[i] = newNode(i);
+		joinTime.push_back((int)(par->STEP_RATE*i));
+		schedule(i, joinTime[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: newNode
+ *
+ * DESCRIPTION: Create a node with the next free address for slot
+ */
+MP1Node *Application::newNode(int slot) {
+	Member *memberNode = new Member;
+	memberNode->inited = false;
+	Address *addressOfMemberNode = new Address();
+	addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
+	MP1Node *node = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
+	log->LOG(&(node->getMemberNode()->addr), "APP");
+	int id = addressOfMemberNode->getid();
+	if ( id >= (int)slotOf.size() ) {
+		slotOf.resize(id + 1, -1);
+	}
+	slotOf[id] = slot;
+	delete addressOfMemberNode;
+	return node;
+}
+
+/**
+ * FUNCTION NAME: schedule
+ *
+ * DESCRIPTION: Have the event scheduler run the node in slot at tick, in place of
+ * 				the tick it was due at before. INT_MAX waits for messages only.
+ */
+void Application::schedule(int slot, int tick) {
+	if ( tick == wakeAt[slot] ) {
+		return;
+	}
+	wakeAt[slot] = tick;
+	if ( tick != INT_MAX ) {
+		timers.push(make_pair(tick, slot));
+	}
+}
+
+/**
+ * FUNCTION NAME: collectActive
+ *
+ * DESCRIPTION: Pick the slots to run in this tick. The tick scheduler runs every
+ * 				node. The event scheduler only runs those with a timer due, those
+ * 				that got messages at the last flush, and the joiners, so its cost
+ * 				follows the events rather than the group size. Either way only
+ * 				nodes that are up, or join in this tick, are kept.
+ */
+void Application::collectActive() {
+	int now = par->getcurrtime();
+	int i, n = 0;
+
+	active.clear();
+	if ( par->SCHEDULER == TICK_SCHEDULER ) {
+		for ( i = 0; i < par->EN_GPSZ; i++ ) {
+			active.push_back(i);
+		}
+	}
+	else {
+		while ( !timers.empty() && timers.top().first <= now ) {
+			if ( timers.top().first == wakeAt[timers.top().second] ) {
+				active.push_back(timers.top().second);
+			}
+			timers.pop();
+		}
+		en->ENtakeReady(readyIds);
+		for ( i = 0; i < (int)readyIds.size(); i++ ) {
+			if ( readyIds[i] < (int)slotOf.size() && slotOf[readyIds[i]] != -1 ) {
+				active.push_back(slotOf[readyIds[i]]);
+			}
+		}
+		#ifdef DEBUGLOG
+		// The first node logs the time every 500 ticks
+		if ( now % 500 == 0 ) {
+			active.push_back(0);
+		}
+		#endif
+		sort(active.begin(), active.end());
+		active.erase(unique(active.begin(), active.end()), active.end());
+	}
+
+	for ( i = 0; i < (int)active.size(); i++ ) {
+		int slot = active[i];
+		if ( now == joinTime[slot] || (now > joinTime[slot] && !mp1[slot]->getMemberNode()->bFailed) ) {
+			active[n++] = slot;
+		}
 	}
+	active.resize(n);
+	nodeRuns += n;
 }
 
 /**
  * Destructor
  */
 Application::~Application() {
+	delete exec;
 	delete log;
 	delete en;
 	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
@@ -93,14 +196,21 @@ int Application::run()
 	int timeWhenAllNodesHaveJoined = 0;
 	// boolean indicating if all nodes have joined
 	bool allNodesJoined = false;
-	srand(time(NULL));
+
+	int runningTime = par->RUN_TIME > 0 ? par->RUN_TIME : TOTAL_RUNNING_TIME;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
 
 	// As time runs along
-	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ++par->globaltime ) {
+	for( par->globaltime = 0; par->globaltime < runningTime; ++par->globaltime ) {
 		// Run the membership protocol
 		mp1Run();
 		// Fail some nodes
 		fail();
+		churn();
+	}
+
+	if ( Profiler::get().isEnabled() ) {
+		writeProfile(chrono::duration<double>(chrono::steady_clock::now() - start).count());
 	}
 
 	// Clean up
@@ -119,47 +229,75 @@ int Application::run()
  * DESCRIPTION:	This function performs all the membership protocol functionalities
  */
 void Application::mp1Run() {
-	int i;
+	bool parallel = exec->getThreads() > 1;
 
-	// For all the nodes in the system
-	for( i = 0; i <= par->EN_GPSZ-1; i++) {
+	collectActive();
+
+	// For all the nodes run in this tick
+	exec->run((int)active.size(), [this](int shard, int begin, int end) {
+		for( int k = begin; k < end; k++) {
+			int i = active[k];
+
+			/*
+			 * Receive messages from the network and queue them in the membership protocol queue
+			 */
+			if( par->getcurrtime() > joinTime[i] && !(mp1[i]->getMemberNode()->bFailed) ) {
+				// Receive messages from the network and queue them
+				mp1[i]->recvLoop();
+			}
 
-		/*
-		 * Receive messages from the network and queue them in the membership protocol queue
-		 */
-		if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
-			// Receive messages from the network and queue them
-			mp1[i]->recvLoop();
 		}
+	});
 
+	/*
+	 * Each shard logs and sends into its own buffers. Flushing them from the last
+	 * shard to the first keeps the serial order of nodes, so the logs and the
+	 * network are the same for any number of threads.
+	 */
+	if ( parallel ) {
+		log->beginStaging(exec->getThreads());
 	}
 
-	// For all the nodes in the system
-	for( i = par->EN_GPSZ - 1; i >= 0; i-- ) {
+	// For all the nodes run in this tick
+	exec->run((int)active.size(), [this](int shard, int begin, int end) {
+		for( int k = end - 1; k >= begin; k-- ) {
+			int i = active[k];
 
-		/*
-		 * Introduce nodes into the distributed system
-		 */
-		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
-			// introduce the ith node into the system at time STEPRATE*i
-			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
-			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
-			nodeCount += i;
-		}
+			/*
+			 * Introduce nodes into the distributed system
+			 */
+			if( par->getcurrtime() == joinTime[i] ) {
+				// introduce the ith node into the system at time STEPRATE*i
+				mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
+				TRACEINFO(cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl);
+				nodeCount += i;
+			}
 
-		/*
-		 * Handle all the messages in your queue and send heartbeats
-		 */
-		else if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
-			// handle messages and send heartbeats
-			mp1[i]->nodeLoop();
-			#ifdef DEBUGLOG
-			if( (i == 0) && (par->globaltime % 500 == 0) ) {
-				log->LOG(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
+			/*
+			 * Handle all the messages in your queue and send heartbeats
+			 */
+			else if( par->getcurrtime() > joinTime[i] && !(mp1[i]->getMemberNode()->bFailed) ) {
+				// handle messages and send heartbeats
+				mp1[i]->nodeLoop();
+				#ifdef DEBUGLOG
+				if( (i == 0) && (par->globaltime % 500 == 0) ) {
+					log->LOG(&mp1[i]->getMemberNode()->addr, "@@time=%d", par->getcurrtime());
+				}
+				#endif
 			}
-			#endif
+
 		}
+	});
 
+	if ( parallel ) {
+		log->flushStaged();
+	}
+	en->ENflush();
+
+	if ( par->SCHEDULER == EVENT_SCHEDULER ) {
+		for ( int k = 0; k < (int)active.size(); k++ ) {
+			schedule(active[k], mp1[active[k]]->getWakeTick());
+		}
 	}
 }
 
@@ -178,20 +316,22 @@ void Application::fail() {
 		par->dropmsg = 1;
 	}
 
-	if( par->SINGLE_FAILURE && par->getcurrtime() == 100 ) {
-		removed = (rand() % par->EN_GPSZ);
+	if( par->SINGLE_FAILURE && par->getcurrtime() == par->FAIL_TIME ) {
+		removed = (rng() % par->EN_GPSZ);
 		#ifdef DEBUGLOG
 		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 		#endif
 		mp1[removed]->getMemberNode()->bFailed = true;
+		Profiler::get().nodeFailed(mp1[removed]->getMemberNode()->addr.getid(), par->getcurrtime());
 	}
-	else if( par->getcurrtime() == 100 ) {
-		removed = rand() % par->EN_GPSZ/2;
+	else if( par->getcurrtime() == par->FAIL_TIME ) {
+		removed = rng() % par->EN_GPSZ/2;
 		for ( i = removed; i < removed + par->EN_GPSZ/2; i++ ) {
 			#ifdef DEBUGLOG
 			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
 			#endif
 			mp1[i]->getMemberNode()->bFailed = true;
+			Profiler::get().nodeFailed(mp1[i]->getMemberNode()->addr.getid(), par->getcurrtime());
 		}
 	}
 
@@ -201,6 +341,145 @@ void Application::fail() {
 
 }
 
+/**
+ * FUNCTION NAME: churn
+ *
+ * DESCRIPTION: Once every node has joined, fail a random node other than the
+ * 				introducer every CHURN_INTERVAL ticks and put a new node with a
+ * 				fresh address in its place, which joins at the next tick
+ */
+void Application::churn() {
+	int now = par->getcurrtime();
+	if ( par->CHURN_INTERVAL <= 0 || par->EN_GPSZ < 2 || now <= joinTime[par->EN_GPSZ - 1]
+		 || now % par->CHURN_INTERVAL != 0 ) {
+		return;
+	}
+
+	int i = 1 + rng() % (par->EN_GPSZ - 1);
+	Member *memberNode = mp1[i]->getMemberNode();
+	slotOf[memberNode->addr.getid()] = -1;
+	if ( !memberNode->bFailed ) {
+		#ifdef DEBUGLOG
+		log->LOG(&memberNode->addr, "Node failed at time=%d", now);
+		#endif
+		memberNode->bFailed = true;
+		Profiler::get().nodeFailed(memberNode->addr.getid(), now);
+	}
+	en->ENclose(&memberNode->addr);
+	delete mp1[i];
+	delete memberNode;
+
+	mp1[i] = newNode(i);
+	joinTime[i] = now + 1;
+	schedule(i, now + 1);
+}
+
+/**
+ * FUNCTION NAME: writeProfile
+ *
+ * DESCRIPTION: Write the statistics of this run as JSON to the PROFILE file.
+ * 				Phase times are summed over all threads; en_send is also part of
+ * 				the phases it is called from.
+ */
+void Application::writeProfile(double wallSec) {
+	static const char *phaseNames[PHASE_COUNT] = { "recv_loop", "check_messages", "node_loop_ops", "en_send" };
+	ShardProfile sum;
+	struct rusage usage;
+	LinkModel *link = en->getLinkModel();
+	int ticks = par->getcurrtime();
+	int failed = Profiler::get().getFailed();
+	// Every node still up should remove every failed node. With churn the
+	// group stays the same size, so all the others should
+	long expected = (long)failed * (par->CHURN_INTERVAL > 0 ? par->EN_GPSZ - 1 : par->EN_GPSZ - failed);
+	// Membership state held by the nodes still up at the end
+	long tableBytes = 0;
+	int entriesMax = 0;
+	int zones = par->zoneCount();
+	int zonesKnownMin = zones > 0 ? zones : 0;
+	vector<int> zoneUp(zones, 0);
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		Member *memberNode = mp1[i]->getMemberNode();
+		if ( !memberNode->bFailed ) {
+			tableBytes += memberNode->memberList.memoryBytes() + mp1[i]->zoneMemoryBytes();
+			entriesMax = max(entriesMax, memberNode->memberList.size());
+			if ( zones > 0 ) {
+				zonesKnownMin = min(zonesKnownMin, mp1[i]->zonesKnown());
+				zoneUp[par->zoneOf(memberNode->addr.getid())]++;
+			}
+		}
+	}
+	// In the hierarchical mode only the members of its zone track a node
+	if ( zones > 0 ) {
+		expected = (long)failed * (min(par->ZONE_SIZE, par->EN_GPSZ) - 1);
+		if ( par->CHURN_INTERVAL == 0 ) {
+			expected = 0;
+			for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+				Member *memberNode = mp1[i]->getMemberNode();
+				if ( memberNode->bFailed ) {
+					expected += zoneUp[par->zoneOf(memberNode->addr.getid())];
+				}
+			}
+		}
+	}
+
+	Profiler::get().total(sum);
+	getrusage(RUSAGE_SELF, &usage);
+
+	FILE *file = fopen(par->PROFILE.c_str(), "w");
+	if ( file == NULL ) {
+		fprintf(stderr, "Cannot write %s\n", par->PROFILE.c_str());
+		return;
+	}
+	fprintf(file, "{\n");
+	fprintf(file, "  \"nodes\": %d,\n", par->EN_GPSZ);
+	fprintf(file, "  \"ticks\": %d,\n", ticks);
+	fprintf(file, "  \"threads\": %d,\n", exec->getThreads());
+	fprintf(file, "  \"inbox_size\": %d,\n", par->INBOX_SIZE);
+	fprintf(file, "  \"seed\": %u,\n", par->SEED);
+	fprintf(file, "  \"replay\": %d,\n", par->REPLAY.empty() ? 0 : 1);
+	fprintf(file, "  \"scheduler\": \"%s\",\n", par->SCHEDULER == TICK_SCHEDULER ? "tick" : "event");
+	fprintf(file, "  \"targets\": \"%s\",\n", par->TARGETS == RANDOM_TARGETS ? "random" : "roundrobin");
+	fprintf(file, "  \"timeouts\": \"%s\",\n", par->TIMEOUTS == SWEEP_TIMEOUTS ? "sweep" : "wheel");
+	fprintf(file, "  \"latency\": %d,\n", par->LATENCY);
+	fprintf(file, "  \"latency_jitter\": %d,\n", par->LATENCY_JITTER);
+	fprintf(file, "  \"bandwidth\": %d,\n", par->BANDWIDTH);
+	fprintf(file, "  \"partitions\": %d,\n", (int)par->PARTITIONS.size());
+	fprintf(file, "  \"single_failure\": %d,\n", par->SINGLE_FAILURE);
+	fprintf(file, "  \"churn_interval\": %d,\n", par->CHURN_INTERVAL);
+	fprintf(file, "  \"drop_prob\": %.3f,\n", par->DROP_MSG ? par->MSG_DROP_PROB : 0.0);
+	fprintf(file, "  \"wall_sec\": %.6f,\n", wallSec);
+	fprintf(file, "  \"ticks_per_sec\": %.2f,\n", wallSec > 0 ? ticks / wallSec : 0.0);
+	fprintf(file, "  \"node_runs\": %ld,\n", nodeRuns);
+	fprintf(file, "  \"msgs_sent\": %ld,\n", en->getSentTotal());
+	fprintf(file, "  \"msgs_dropped\": %ld,\n", en->getDroppedTotal());
+	fprintf(file, "  \"envelopes\": %ld,\n", en->getEnvelopesTotal());
+	fprintf(file, "  \"partition_drops\": %ld,\n", link->getPartitionDrops());
+	fprintf(file, "  \"burst_drops\": %ld,\n", link->getBurstDrops());
+	fprintf(file, "  \"queue_drops\": %ld,\n", link->getQueueDrops());
+	fprintf(file, "  \"queued_msgs\": %ld,\n", link->getQueued());
+	fprintf(file, "  \"queue_wait_mean\": %.2f,\n", link->getQueued() ? (double)link->getQueueTicks() / link->getQueued() : 0.0);
+	fprintf(file, "  \"msgs_per_sec\": %.2f,\n", wallSec > 0 ? en->getSentTotal() / wallSec : 0.0);
+	fprintf(file, "  \"peak_rss_kb\": %ld,\n", usage.ru_maxrss);
+	fprintf(file, "  \"max_msg_bytes\": %d,\n", en->getMaxMsgSize());
+	fprintf(file, "  \"member_entries_max\": %d,\n", entriesMax);
+	fprintf(file, "  \"member_table_bytes\": %ld,\n", tableBytes);
+	fprintf(file, "  \"zone_size\": %d,\n", zones > 0 ? par->ZONE_SIZE : 0);
+	fprintf(file, "  \"zones_known_min\": %d,\n", zonesKnownMin);
+	fprintf(file, "  \"phase_sec\": {");
+	for ( int p = 0; p < PHASE_COUNT; p++ ) {
+		fprintf(file, "%s\"%s\": %.6f", p ? ", " : " ", phaseNames[p], sum.phaseSec[p]);
+	}
+	fprintf(file, " },\n");
+	fprintf(file, "  \"failed_nodes\": %d,\n", failed);
+	fprintf(file, "  \"detections\": %ld,\n", sum.detections);
+	fprintf(file, "  \"detections_expected\": %ld,\n", expected);
+	fprintf(file, "  \"false_removals\": %ld,\n", sum.falseRemovals);
+	fprintf(file, "  \"detection_latency_mean\": %.2f,\n", sum.detections ? (double)sum.latencySum / sum.detections : 0.0);
+	fprintf(file, "  \"detection_latency_max\": %d\n", sum.latencyMax);
+	fprintf(file, "}\n");
+	fclose(file);
+}
+
 /**
  * FUNCTION NAME: getjoinaddr
  *
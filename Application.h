@@ -13,12 +13,16 @@
 #include "Params.h"
 #include "Member.h"
 #include "EmulNet.h"
-#include "Queue.h"
+#include "TickExecutor.h"
+#include "Profiler.h"
+#include "Random.h"
+#include <atomic>
+#include <sys/resource.h>
 
 /**
  * global variables
  */
-int nodeCount = 0;
+atomic<long> nodeCount(0);
 
 /*
  * Macros
@@ -39,14 +43,35 @@ private:
 	EmulNet *en;
     Log *log;
 	MP1Node **mp1;
+	// Tick each node slot is introduced into the group at
+	vector<int> joinTime;
 	Params *par;
+	TickExecutor *exec;
+	// Picks the nodes that fail and churn
+	Random rng;
+	// Event scheduler: (tick, slot) of the nodes with a timer due, soonest first.
+	// An entry only counts if its tick is still the one in wakeAt.
+	priority_queue< pair<int, int>, vector< pair<int, int> >, greater< pair<int, int> > > timers;
+	vector<int> wakeAt;
+	// Slot of each node id, -1 once the node is gone
+	vector<int> slotOf;
+	// Slots run in this tick, in ascending order, and the ids that got messages
+	vector<int> active;
+	vector<int> readyIds;
+	// Nodes run over the whole run, counting joins
+	long nodeRuns;
+	MP1Node *newNode(int slot);
+	void schedule(int slot, int tick);
+	void collectActive();
 public:
-	Application(char *);
+	Application(char *infile, int nargs, char *args[]);
 	virtual ~Application();
 	Address getjoinaddr();
 	int run();
 	void mp1Run();
 	void fail();
+	void churn();
+	void writeProfile(double wallSec);
 };
 
 #endif /* _APPLICATION_H__ */
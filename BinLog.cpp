@@ -0,0 +1,190 @@
+/**********************************
+ * FILE NAME: BinLog.cpp
+ *
+ * DESCRIPTION: Definition of the binary event log
+ **********************************/
+
+#include "BinLog.h"
+
+/**
+ * Constructor
+ */
+LogRing::LogRing(): head(0), tail(0) {
+	ring = new LogRecord[BINLOG_RING];
+}
+
+/**
+ * Destructor
+ */
+LogRing::~LogRing() {
+	delete[] ring;
+}
+
+/**
+ * FUNCTION NAME: push
+ *
+ * DESCRIPTION: Append a record, waiting for the consumer while the ring is full
+ */
+void LogRing::push(const LogRecord &rec) {
+	unsigned long h = head.load(memory_order_relaxed);
+	while ( h - tail.load(memory_order_acquire) >= BINLOG_RING ) {
+		this_thread::yield();
+	}
+	ring[h & (BINLOG_RING - 1)] = rec;
+	head.store(h + 1, memory_order_release);
+}
+
+/**
+ * FUNCTION NAME: pop
+ *
+ * DESCRIPTION: Take up to max records off the ring into out. Returns how many.
+ */
+int LogRing::pop(LogRecord *out, int max) {
+	unsigned long t = tail.load(memory_order_relaxed);
+	unsigned long avail = head.load(memory_order_acquire) - t;
+	int n = avail < (unsigned long)max ? (int)avail : max;
+	for ( int i = 0; i < n; i++ ) {
+		out[i] = ring[(t + i) & (BINLOG_RING - 1)];
+	}
+	tail.store(t + n, memory_order_release);
+	return n;
+}
+
+/**
+ * Constructor
+ */
+BinLogWriter::BinLogWriter(const char *file): stopping(false) {
+	BinLogHdr hdr;
+	fp = fopen(file, "wb");
+	if ( fp == NULL ) {
+		return;
+	}
+	hdr.magic = BINLOG_MAGIC;
+	hdr.version = BINLOG_VERSION;
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+	drainer = thread(&BinLogWriter::drain, this);
+}
+
+/**
+ * Destructor
+ * Writes out every record still in the ring
+ */
+BinLogWriter::~BinLogWriter() {
+	if ( fp == NULL ) {
+		return;
+	}
+	stopping = true;
+	drainer.join();
+	fclose(fp);
+}
+
+/**
+ * FUNCTION NAME: drain
+ *
+ * DESCRIPTION: Background thread moving records from the ring to the file
+ */
+void BinLogWriter::drain() {
+	LogRecord batch[1024];
+	while ( true ) {
+		bool last = stopping;
+		int n = ring.pop(batch, 1024);
+		if ( n > 0 ) {
+			fwrite(batch, sizeof(LogRecord), n, fp);
+		}
+		else if ( last ) {
+			return;
+		}
+		else {
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: makeEvent
+ *
+ * DESCRIPTION: Fill in an event about a peer, such as a node add or remove
+ */
+void BinLogWriter::makeEvent(LogRecord &rec, int time, const char *self, int type, const char *peer) {
+	memset(&rec, 0, sizeof(rec));
+	rec.time = time;
+	memcpy(rec.self, self, sizeof(rec.self));
+	rec.type = type;
+	memcpy(rec.peer, peer, sizeof(rec.peer));
+}
+
+/**
+ * FUNCTION NAME: makeText
+ *
+ * DESCRIPTION: Append the records carrying a free form line of text to out
+ */
+void BinLogWriter::makeText(vector<LogRecord> &out, int time, const char *self, int type, const char *text) {
+	LogRecord rec;
+	int len = strlen(text);
+	int off = 0;
+	do {
+		int n = len - off < BINLOG_TEXT ? len - off : BINLOG_TEXT;
+		memset(&rec, 0, sizeof(rec));
+		rec.time = time;
+		memcpy(rec.self, self, sizeof(rec.self));
+		rec.type = type | (off + n < len ? LOG_EV_MORE : 0);
+		rec.len = n;
+		memcpy(rec.text, text + off, n);
+		out.push_back(rec);
+		off += n;
+	} while ( off < len );
+}
+
+/**
+ * FUNCTION NAME: render
+ *
+ * DESCRIPTION: Print a binary log as the text Log writes to dbg.log and stats.log.
+ * 				Returns the number of lines, -1 if in is not a binary log.
+ */
+int BinLogWriter::render(FILE *in, FILE *dbg, FILE *stats, const char *magic) {
+	BinLogHdr hdr;
+	LogRecord rec;
+	char addr[30], peer[30];
+	string text;
+	int lines = 0;
+
+	if ( fread(&hdr, sizeof(hdr), 1, in) != 1 || hdr.magic != BINLOG_MAGIC || hdr.version != BINLOG_VERSION ) {
+		return -1;
+	}
+
+	while ( fread(&rec, sizeof(rec), 1, in) == 1 ) {
+		int type = rec.type & ~LOG_EV_MORE;
+		if ( type == LOG_EV_TEXT || type == LOG_EV_STATS ) {
+			text.append(rec.text, rec.len);
+			if ( rec.type & LOG_EV_MORE ) {
+				continue;
+			}
+		}
+
+		if ( lines == 0 ) {
+			int magicNumber = 0;
+			for ( int i = 0; magic[i]; i++ ) {
+				magicNumber += (int)magic[i];
+			}
+			fprintf(dbg, "%x\n", magicNumber);
+			// Log leaves out the address of the very first line
+			addr[0] = 0;
+		}
+		else {
+			sprintf(addr, "%d.%d.%d.%d:%d ", rec.self[0], rec.self[1], rec.self[2], rec.self[3], *(short *)&rec.self[4]);
+		}
+
+		FILE *out = type == LOG_EV_STATS ? stats : dbg;
+		fprintf(out, "\n %s[%d] ", addr, rec.time);
+		if ( type == LOG_EV_ADD || type == LOG_EV_REMOVE ) {
+			sprintf(peer, "%d.%d.%d.%d:%d", rec.peer[0], rec.peer[1], rec.peer[2], rec.peer[3], *(short *)&rec.peer[4]);
+			fprintf(out, "Node %s %s at time %d", peer, type == LOG_EV_ADD ? "joined" : "removed", rec.time);
+		}
+		else {
+			fputs(text.c_str(), out);
+			text.clear();
+		}
+		lines++;
+	}
+	return lines;
+}
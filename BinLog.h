@@ -0,0 +1,116 @@
+/**********************************
+ * FILE NAME: BinLog.h
+ *
+ * DESCRIPTION: Binary event log written in the background, rendered to dbg.log offline
+ **********************************/
+
+#ifndef _BINLOG_H_
+#define _BINLOG_H_
+
+#include "stdincludes.h"
+#include <atomic>
+#include <thread>
+
+/*
+ * Macros
+ */
+#define BINLOG_MAGIC 0x474f4c42
+#define BINLOG_VERSION 1
+// Text bytes carried by one record, longer text continues in the next records
+#define BINLOG_TEXT 20
+// Records the ring holds, a power of two
+#define BINLOG_RING 65536
+
+/**
+ * Event types of a LogRecord
+ */
+enum LogEventType {
+	LOG_EV_ADD,
+	LOG_EV_REMOVE,
+	LOG_EV_TEXT,
+	LOG_EV_STATS
+};
+// Set on a text record when the text goes on in the next record
+#define LOG_EV_MORE 0x80
+
+/**
+ * STRUCT NAME: BinLogHdr
+ *
+ * DESCRIPTION: Start of a binary log file
+ */
+typedef struct BinLogHdr {
+	int32_t magic;
+	int32_t version;
+}BinLogHdr;
+
+/**
+ * STRUCT NAME: LogRecord
+ *
+ * DESCRIPTION: One fixed size log event. Addresses are kept as raw bytes so
+ * 				they render exactly as Log prints them.
+ */
+#pragma pack(push, 1)
+typedef struct LogRecord {
+	int32_t time;
+	char self[6];
+	uint8_t type;
+	uint8_t len;
+	union {
+		char peer[6];
+		char text[BINLOG_TEXT];
+	};
+}LogRecord;
+#pragma pack(pop)
+
+/**
+ * CLASS NAME: LogRing
+ *
+ * DESCRIPTION: Lock-free ring of records between one producer and one consumer.
+ * 				push waits for room rather than dropping, so no event is lost.
+ */
+class LogRing {
+private:
+	LogRecord *ring;
+	atomic<unsigned long> head;
+	atomic<unsigned long> tail;
+public:
+	LogRing();
+	virtual ~LogRing();
+	void push(const LogRecord &rec);
+	int pop(LogRecord *out, int max);
+private:
+	LogRing(const LogRing &anotherRing);
+	LogRing& operator =(const LogRing &anotherRing);
+};
+
+/**
+ * CLASS NAME: BinLogWriter
+ *
+ * DESCRIPTION: Owns a LogRing and the thread that drains it into a binary log file.
+ * 				Records are written in the order they were pushed.
+ */
+class BinLogWriter {
+private:
+	FILE *fp;
+	LogRing ring;
+	atomic<bool> stopping;
+	thread drainer;
+	void drain();
+public:
+	BinLogWriter(const char *file);
+	virtual ~BinLogWriter();
+	bool isOpen() {
+		return fp != NULL;
+	}
+	void write(const LogRecord &rec) {
+		ring.push(rec);
+	}
+	static void makeEvent(LogRecord &rec, int time, const char *self, int type, const char *peer);
+	static void makeText(vector<LogRecord> &out, int time, const char *self, int type, const char *text);
+	static int render(FILE *in, FILE *dbg, FILE *stats, const char *magic);
+private:
+	BinLogWriter(const BinLogWriter &anotherWriter);
+	BinLogWriter& operator =(const BinLogWriter &anotherWriter);
+};
+
+#endif /* _BINLOG_H_ */
@@ -12,17 +12,24 @@
 EmulNet::EmulNet(Params *p)
 {
 	//trace.funcEntry("EmulNet::EmulNet");
-	int i,j;
 	par = p;
+	initShards();
 	emulnet.setNextId(1);
 	emulnet.settCurrBuffSize(0);
 	enInited=0;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			sent_msgs[i][j] = 0;
-			recv_msgs[i][j] = 0;
-		}
+	buffLimit = ENBUFFSIZE;
+	if ( par->EN_GPSZ > ENBUFFNODES ) {
+		buffLimit = (int)((long)ENBUFFSIZE * par->EN_GPSZ / ENBUFFNODES);
 	}
+	traffic.reserve(par->EN_GPSZ + 1);
+	sentTotal = 0;
+	droppedTotal = 0;
+	envelopesTotal = 0;
+	maxMsgSize = 0;
+	initTrace();
+	rng.seed(par->SEED, RNG_STREAM_NET);
+	link = NULL;
+	setLinkModel(new LinkModel(par));
 	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
 }
 
@@ -30,39 +37,114 @@ EmulNet::EmulNet(Params *p)
  * Copy constructor
  */
 EmulNet::EmulNet(EmulNet &anotherEmulNet) {
-	int i, j;
 	this->par = anotherEmulNet.par;
+	initShards();
 	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
+	this->buffLimit = anotherEmulNet.buffLimit;
+	this->traffic = anotherEmulNet.traffic;
+	this->closed = anotherEmulNet.closed;
+	this->sentTotal = anotherEmulNet.sentTotal;
+	this->droppedTotal = anotherEmulNet.droppedTotal;
+	this->envelopesTotal = anotherEmulNet.envelopesTotal;
+	this->maxMsgSize = anotherEmulNet.maxMsgSize;
 	this->emulnet = anotherEmulNet.emulnet;
+	this->rng = anotherEmulNet.rng;
+	// The trace file stays with the original
+	this->msgTrace = NULL;
+	this->replaying = false;
+	this->link = NULL;
+	setLinkModel(new LinkModel(par));
 }
 
 /**
  * Assignment operator overloading
  */
 EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
-	int i, j;
 	this->par = anotherEmulNet.par;
 	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
+	this->buffLimit = anotherEmulNet.buffLimit;
+	this->traffic = anotherEmulNet.traffic;
+	this->closed = anotherEmulNet.closed;
+	this->sentTotal = anotherEmulNet.sentTotal;
+	this->droppedTotal = anotherEmulNet.droppedTotal;
+	this->envelopesTotal = anotherEmulNet.envelopesTotal;
+	this->maxMsgSize = anotherEmulNet.maxMsgSize;
 	this->emulnet = anotherEmulNet.emulnet;
+	this->rng = anotherEmulNet.rng;
 	return *this;
 }
 
 /**
  * Destructor
  */
-EmulNet::~EmulNet() {}
+EmulNet::~EmulNet() {
+	delete msgTrace;
+	delete link;
+	for ( int i = 0; i < (int)arenas.size(); i++ ) {
+		delete arenas[i];
+	}
+}
+
+/**
+ * FUNCTION NAME: initShards
+ *
+ * DESCRIPTION: Set up the per shard arenas and outboxes, one per simulation thread
+ */
+void EmulNet::initShards() {
+	int shards = par->THREADS < 1 ? 1 : par->THREADS;
+	for ( int i = 0; i < shards; i++ ) {
+		arenas.push_back(new MsgArena(par->MAX_MSG_SIZE));
+	}
+	emulnet.outbox.resize(shards);
+	emulnet.outparts.resize(shards);
+	received.assign(shards, 0);
+}
+
+/**
+ * FUNCTION NAME: initTrace
+ *
+ * DESCRIPTION: Open the trace to record the delivered messages to, or to replay
+ * 				them from. A replayed run takes the seed of the recorded one, so the
+ * 				failures and the nodes' own random choices are the same too.
+ */
+void EmulNet::initTrace() {
+	msgTrace = NULL;
+	replaying = false;
+	if ( !par->REPLAY.empty() ) {
+		msgTrace = new MsgTrace();
+		if ( !msgTrace->openReplay(par->REPLAY.c_str()) ) {
+			fprintf(stderr, "Cannot replay %s\n", par->REPLAY.c_str());
+			exit(1);
+		}
+		if ( msgTrace->getNodes() != par->EN_GPSZ ) {
+			fprintf(stderr, "%s was recorded with %d nodes, not %d\n", par->REPLAY.c_str(), msgTrace->getNodes(), par->EN_GPSZ);
+		}
+		par->SEED = msgTrace->getSeed();
+		replaying = true;
+	}
+	else if ( !par->RECORD.empty() ) {
+		msgTrace = new MsgTrace();
+		if ( !msgTrace->openRecord(par->RECORD.c_str(), par->SEED, par->EN_GPSZ) ) {
+			fprintf(stderr, "Cannot write %s\n", par->RECORD.c_str());
+			exit(1);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: addNode
+ *
+ * DESCRIPTION: Make room for the mailbox and counters of node id
+ */
+void EmulNet::addNode(int id) {
+	if ( id >= (int)emulnet.mailbox.size() ) {
+		emulnet.mailbox.resize(id + 1);
+		emulnet.parts.resize(id + 1);
+		emulnet.readpos.resize(id + 1, 0);
+		traffic.resize(id + 1);
+		closed.resize(id + 1, 0);
+	}
+}
 
 /**
  * FUNCTION NAME: ENinit
@@ -73,48 +155,347 @@ void *EmulNet::ENinit(Address *myaddr, short port) {
 	// Initialize data structures for this member
 	*(int *)(myaddr->addr) = emulnet.nextid++;
     *(short *)(&myaddr->addr[4]) = 0;
+	addNode(emulnet.nextid - 1);
 	return myaddr;
 }
 
+/**
+ * FUNCTION NAME: newPayload
+ *
+ * DESCRIPTION: Copy data into a payload of the calling shard that refs recipients
+ * 				will release. Returns NULL if the message is too large.
+ */
+en_payload *EmulNet::newPayload(char *data, int size, int refs) {
+	if ( size < 0 || size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE ) {
+		return NULL;
+	}
+	en_payload *payload = (en_payload *)arenas[TickExecutor::currentShard()]->alloc(sizeof(en_payload) + size);
+	if ( payload == NULL ) {
+		return NULL;
+	}
+	payload->size = size;
+	payload->refs.store(refs, memory_order_relaxed);
+	memcpy((char *)(payload + 1), data, size);
+	return payload;
+}
+
+/**
+ * FUNCTION NAME: unref
+ *
+ * DESCRIPTION: Drop one recipient of payload, recycling its slot after the last
+ */
+void EmulNet::unref(en_payload *payload) {
+	if ( payload->refs.fetch_sub(1, memory_order_acq_rel) == 1 ) {
+		arenas[TickExecutor::currentShard()]->release(payload);
+	}
+}
+
 /**
  * FUNCTION NAME: ENsend
  *
- * DESCRIPTION: EmulNet send function
+ * DESCRIPTION: EmulNet send function. The message goes into the outbox of the
+ * 				calling shard and reaches its mailbox at the next ENflush.
+ * 				Safe to call from all shards at once.
  *
  * RETURNS:
  * size
  */
 int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
-	en_msg *em;
-	static char temp[2048];
-	int sendmsg = rand() % 100;
+	return ENsendv(myaddr, toaddr, 1, data, size);
+}
 
-	if( (emulnet.currbuffsize >= ENBUFFSIZE) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) ) {
+/**
+ * FUNCTION NAME: ENsendv
+ *
+ * DESCRIPTION: Send the same message to the n nodes in toaddrs. The payload is
+ * 				copied once and shared by all of them.
+ *
+ * RETURNS:
+ * size, 0 if nothing was sent
+ */
+int EmulNet::ENsendv(Address *myaddr, Address *toaddrs, int n, char *data, int size) {
+	ProfileScope profile(PHASE_EN_SEND);
+	int shard = TickExecutor::currentShard();
+	int i, refs = 0;
+
+	for ( i = 0; i < n; i++ ) {
+		if ( toaddrs[i].getid() >= 0 ) {
+			refs++;
+		}
+	}
+	if ( refs == 0 ) {
+		return 0;
+	}
+	en_payload *payload = newPayload(data, size, refs);
+	if ( payload == NULL ) {
 		return 0;
 	}
 
-	em = (en_msg *)malloc(sizeof(en_msg) + size);
-	em->size = size;
+	for ( i = 0; i < n; i++ ) {
+		if ( toaddrs[i].getid() < 0 ) {
+			continue;
+		}
+		en_msg em;
+		em.size = size;
+		em.from = myaddr->nodeId();
+		em.to = toaddrs[i].nodeId();
+		em.count = 1;
+		em.time = 0;
+		emulnet.outbox[shard].push_back(em);
+		emulnet.outparts[shard].push_back(payload);
+
+		TRACEMSG(printf("Sending 4+%d B msg type %d to %d.%d.%d.%d:%d \n", size-4, *(int *)data, toaddrs[i].addr[0], toaddrs[i].addr[1], toaddrs[i].addr[2], toaddrs[i].addr[3], *(short *)&toaddrs[i].addr[4]));
+	}
 
-	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
-	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
-	memcpy(em + 1, data, size);
+	return size;
+}
 
-	emulnet.buff[emulnet.currbuffsize++] = em;
+/**
+ * FUNCTION NAME: ENsendv
+ *
+ * DESCRIPTION: Send the n messages in data, of sizes bytes, to toaddr in one
+ * 				envelope. Messages too large to send are skipped.
+ *
+ * RETURNS:
+ * Bytes sent
+ */
+int EmulNet::ENsendv(Address *myaddr, Address *toaddr, char **data, int *sizes, int n) {
+	ProfileScope profile(PHASE_EN_SEND);
+	int shard = TickExecutor::currentShard();
+	en_msg em;
 
-	int src = *(int *)(myaddr->addr);
-	int time = par->getcurrtime();
+	if ( toaddr->getid() < 0 ) {
+		return 0;
+	}
+	em.size = 0;
+	em.from = myaddr->nodeId();
+	em.to = toaddr->nodeId();
+	em.count = 0;
+	em.time = 0;
+	for ( int i = 0; i < n; i++ ) {
+		en_payload *payload = newPayload(data[i], sizes[i], 1);
+		if ( payload == NULL ) {
+			continue;
+		}
+		emulnet.outparts[shard].push_back(payload);
+		em.size += sizes[i];
+		em.count++;
+	}
+	if ( em.count > 0 ) {
+		emulnet.outbox[shard].push_back(em);
+	}
 
-	assert(src <= MAX_NODES);
-	assert(time < MAX_TIME);
+	return em.size;
+}
 
-	sent_msgs[src][time]++;
+/**
+ * FUNCTION NAME: ENflush
+ *
+ * DESCRIPTION: Move the messages sent since the last flush into their mailboxes,
+ * 				dropping them as configured. Called once no shard is sending.
+ * 				Outboxes are merged from the last shard to the first, the order a
+ * 				single thread walks the nodes in, so the drop decisions and the
+ * 				mailbox order do not depend on the number of threads.
+ * 				All the messages of a tick from one node to the same destination
+ * 				are coalesced into one envelope, as long as it stays within
+ * 				MAX_MSG_SIZE. Drops are still decided per message, so the loss
+ * 				rate and the buffer limit mean what they did before coalescing.
+ * 				Messages are received at the next tick, or as many ticks later
+ * 				as the link model delays them. Those held back arrive ahead of
+ * 				the ones sent in the tick they arrive in. The link model may
+ * 				drop messages too; partitions are decided when a message is sent.
+ * 				When replaying a trace, the messages sent are counted and
+ * 				discarded, and the recorded ones of this tick are delivered.
+ */
+void EmulNet::ENflush() {
+	int shard, i, k;
+	int now = par->getcurrtime();
 
-	#ifdef DEBUGLOG
-		sprintf(temp, "Sending 4+%d B msg type %d to %d.%d.%d.%d:%d ", size-4, *(int *)data, toaddr->addr[0], toaddr->addr[1], toaddr->addr[2], toaddr->addr[3], *(short *)&toaddr->addr[4]);
-	#endif
+	for ( shard = 0; shard < (int)received.size(); shard++ ) {
+		emulnet.currbuffsize -= received[shard];
+		received[shard] = 0;
+	}
 
-	return size;
+	arrive(now);
+
+	for ( shard = (int)emulnet.outbox.size() - 1; shard >= 0; shard-- ) {
+		vector<en_msg> &out = emulnet.outbox[shard];
+		vector<en_payload*> &outparts = emulnet.outparts[shard];
+		int next = 0;
+		for ( i = 0; i < (int)out.size(); i++ ) {
+			en_msg &em = out[i];
+			int src = em.from.getid();
+			int dst = em.to.getid();
+			addNode(src);
+			addNode(dst);
+			for ( k = 0; k < em.count; k++ ) {
+				en_payload *payload = outparts[next++];
+				int delay = 0;
+				sentTotal++;
+
+				if ( !replaying ) {
+					int sendmsg = rng() % 100;
+					if( (emulnet.currbuffsize >= buffLimit) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) ) {
+						unref(payload);
+						droppedTotal++;
+						continue;
+					}
+					delay = link->route(src, dst, payload->size, now, rng);
+					if ( delay == LINK_DROPPED ) {
+						unref(payload);
+						droppedTotal++;
+						continue;
+					}
+				}
+
+				traffic[src].at(now).sent++;
+				traffic[src].sent_bytes += payload->size;
+				if ( payload->size > maxMsgSize ) {
+					maxMsgSize = payload->size;
+				}
+
+				if ( closed[dst] || replaying ) {
+					unref(payload);
+					continue;
+				}
+				if ( delay == 0 ) {
+					deliver(dst, em, payload, now);
+					continue;
+				}
+				// Counts against the buffer from now on, like a message in a mailbox
+				en_msg one = em;
+				one.size = payload->size;
+				one.count = 1;
+				int slot = (now + delay) % (int)emulnet.inflight.size();
+				emulnet.inflight[slot].push_back(one);
+				emulnet.inflightparts[slot].push_back(payload);
+				emulnet.currbuffsize++;
+			}
+		}
+		out.clear();
+		outparts.clear();
+	}
+
+	if ( replaying ) {
+		MsgTraceRecord rec;
+		char *data;
+		while ( msgTrace->next(now, rec, data) ) {
+			en_msg em;
+			em.size = rec.size;
+			em.from = NodeId::fromBytes(rec.from);
+			em.to = NodeId::fromBytes(rec.to);
+			em.count = 1;
+			em.time = 0;
+			int dst = em.to.getid();
+			addNode(dst);
+			if ( closed[dst] ) {
+				continue;
+			}
+			en_payload *payload = newPayload(data, rec.size, 1);
+			if ( payload != NULL ) {
+				deliver(dst, em, payload, now);
+			}
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: arrive
+ *
+ * DESCRIPTION: Deliver the messages held back by the latency that arrive in this tick
+ */
+void EmulNet::arrive(int now) {
+	int slot = now % (int)emulnet.inflight.size();
+	vector<en_msg> &due = emulnet.inflight[slot];
+	vector<en_payload*> &dueparts = emulnet.inflightparts[slot];
+	for ( int i = 0; i < (int)due.size(); i++ ) {
+		int dst = due[i].to.getid();
+		emulnet.currbuffsize--;
+		if ( closed[dst] ) {
+			unref(dueparts[i]);
+			continue;
+		}
+		deliver(dst, due[i], dueparts[i], now);
+	}
+	due.clear();
+	dueparts.clear();
+}
+
+/**
+ * FUNCTION NAME: deliver
+ *
+ * DESCRIPTION: Put payload, sent in em, into the mailbox of dst, in the envelope
+ * 				from the same node this tick if there is room in it
+ */
+void EmulNet::deliver(int dst, en_msg &em, en_payload *payload, int now) {
+	vector<en_msg> &inbox = emulnet.mailbox[dst];
+	if ( inbox.empty() ) {
+		ready.push_back(dst);
+	}
+	if ( inbox.empty() || inbox.back().time != now || inbox.back().from != em.from
+		|| inbox.back().size + payload->size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE ) {
+		en_msg envelope = em;
+		envelope.size = 0;
+		envelope.count = 0;
+		envelope.time = now;
+		inbox.push_back(envelope);
+		envelopesTotal++;
+	}
+	inbox.back().size += payload->size;
+	inbox.back().count++;
+	emulnet.parts[dst].push_back(payload);
+	emulnet.currbuffsize++;
+	if ( msgTrace != NULL && !replaying ) {
+		msgTrace->record(now, em.from, em.to, (char *)(payload + 1), payload->size);
+	}
+}
+
+/**
+ * FUNCTION NAME: ENtakeReady
+ *
+ * DESCRIPTION: Hand over the ids of the nodes that got messages since the last
+ * 				call, for the scheduler to run. Nodes that had messages waiting
+ * 				already are not repeated.
+ */
+void EmulNet::ENtakeReady(vector<int> &ids) {
+	ids.clear();
+	ids.swap(ready);
+}
+
+/**
+ * FUNCTION NAME: setLinkModel
+ *
+ * DESCRIPTION: Replace the link model, which EmulNet then owns. Must be set before
+ * 				any message is held back, as the ring of messages on their way
+ * 				is sized for the longest delay of the model.
+ */
+void EmulNet::setLinkModel(LinkModel *model) {
+	delete link;
+	link = model;
+	emulnet.inflight.resize(link->maxDelay() + 1);
+	emulnet.inflightparts.resize(link->maxDelay() + 1);
+}
+
+/**
+ * FUNCTION NAME: ENclose
+ *
+ * DESCRIPTION: Take a node that will never receive again off the network. Its
+ * 				waiting messages are recycled and later ones are discarded, so
+ * 				they do not fill up the buffer. Called between simulation phases.
+ */
+void EmulNet::ENclose(Address *addr) {
+	int id = addr->getid();
+	addNode(id);
+	vector<en_payload*> &waiting = emulnet.parts[id];
+	int &read = emulnet.readpos[id];
+	for ( int i = read; i < (int)waiting.size(); i++ ) {
+		unref(waiting[i]);
+	}
+	emulnet.currbuffsize -= (int)waiting.size() - read;
+	read = 0;
+	vector<en_payload*>().swap(waiting);
+	vector<en_msg>().swap(emulnet.mailbox[id]);
+	closed[id] = 1;
 }
 
 /**
@@ -126,17 +507,17 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
  * size
  */
 int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
-	char * str = (char *) malloc(data.length() * sizeof(char));
-	memcpy(str, data.c_str(), data.size());
-	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
-	free(str);
-	return ret;
+	return this->ENsend(myaddr, toaddr, &data[0], (data.length() * sizeof(char)));
 }
 
 /**
  * FUNCTION NAME: ENrecv
  *
- * DESCRIPTION: EmulNet receive function
+ * DESCRIPTION: EmulNet receive function. Delivers the messages of the envelopes
+ * 				in this node's mailbox, one by one in the order they were sent. The
+ * 				payload is handed to enq in place and stays owned by EmulNet until
+ * 				passed to ENrelease.
+ * 				Shards may receive for different nodes at the same time.
  *
  * RETURN:
  * 0
@@ -144,36 +525,92 @@ int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
 int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
 	// times is always assumed to be 1
 	int i;
-	char* tmp;
-	int sz;
-	en_msg *emsg;
+	en_payload *payload;
+	int dst = myaddr->getid();
 
-	for( i = emulnet.currbuffsize - 1; i >= 0; i-- ) {
-		emsg = emulnet.buff[i];
-
-		if ( 0 == strcmp(emsg->to.addr, myaddr->addr) ) {
-			sz = emsg->size;
-			tmp = (char *) malloc(sz * sizeof(char));
-			memcpy(tmp, (char *)(emsg+1), sz);
+	if ( dst < 0 || dst >= (int)emulnet.mailbox.size() ) {
+		return 0;
+	}
+	// The payloads of all envelopes are kept in delivery order
+	vector<en_payload*> &waiting = emulnet.parts[dst];
+	int &read = emulnet.readpos[dst];
+	NodeTraffic &counts = traffic[dst];
 
-			emulnet.buff[i] = emulnet.buff[emulnet.currbuffsize-1];
-			emulnet.currbuffsize--;
+	for( i = read; i < (int)waiting.size(); i++ ) {
+		payload = waiting[i];
 
-			(*enq)(queue, (char *)tmp, sz);
+		(*enq)(queue, (char *)(payload + 1), payload->size);
 
-			free(emsg);
+		counts.at(par->getcurrtime()).recv++;
+		counts.recv_bytes += payload->size;
+	}
+	received[TickExecutor::currentShard()] += (int)waiting.size() - read;
+	read = 0;
+	waiting.clear();
+	emulnet.mailbox[dst].clear();
 
-			int dst = *(int *)(myaddr->addr);
-			int time = par->getcurrtime();
+	return 0;
+}
 
-			assert(dst <= MAX_NODES);
-			assert(time < MAX_TIME);
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: Deliver the messages in this node's mailbox straight into inbox,
+ * 				a batch at a time, in the order they were sent. The payloads stay
+ * 				owned by EmulNet until passed to ENrelease. What the inbox has no
+ * 				room for stays in the mailbox for the next call.
+ * 				Shards may receive for different nodes at the same time.
+ *
+ * RETURN:
+ * Number of messages left in the mailbox
+ */
+int EmulNet::ENrecv(Address *myaddr, Inbox *inbox) {
+	InboxMsg batch[INBOX_DELIVER_BATCH];
+	int dst = myaddr->getid();
 
-			recv_msgs[dst][time]++;
+	if ( dst < 0 || dst >= (int)emulnet.mailbox.size() ) {
+		return 0;
+	}
+	vector<en_payload*> &waiting = emulnet.parts[dst];
+	int &read = emulnet.readpos[dst];
+	NodeTraffic &counts = traffic[dst];
+	int start = read;
+
+	while ( read < (int)waiting.size() ) {
+		int n = min((int)waiting.size() - read, INBOX_DELIVER_BATCH);
+		for ( int i = 0; i < n; i++ ) {
+			batch[i].data = (char *)(waiting[read + i] + 1);
+			batch[i].size = waiting[read + i]->size;
+		}
+		int pushed = inbox->push(batch, n);
+		for ( int i = 0; i < pushed; i++ ) {
+			counts.at(par->getcurrtime()).recv++;
+			counts.recv_bytes += batch[i].size;
+		}
+		read += pushed;
+		if ( pushed < n ) {
+			break;
 		}
 	}
+	received[TickExecutor::currentShard()] += read - start;
+	// Only the read offset moves until the whole mailbox has been handed over
+	if ( read == (int)waiting.size() ) {
+		read = 0;
+		waiting.clear();
+		emulnet.mailbox[dst].clear();
+	}
 
-	return 0;
+	return (int)waiting.size() - read;
+}
+
+/**
+ * FUNCTION NAME: ENrelease
+ *
+ * DESCRIPTION: Done with a payload delivered by ENrecv. Its slot is recycled once
+ * 				every recipient has released it.
+ */
+void EmulNet::ENrelease(char *data) {
+	unref((en_payload *)data - 1);
 }
 
 /**
@@ -188,31 +625,59 @@ int EmulNet::ENcleanup() {
 
 	FILE* file = fopen("msgcount.log", "w+");
 
-	while(emulnet.currbuffsize > 0) {
-		free(emulnet.buff[--emulnet.currbuffsize]);
+	for ( i = 0; i < (int)emulnet.mailbox.size(); i++ ) {
+		for ( j = emulnet.readpos[i]; j < (int)emulnet.parts[i].size(); j++ ) {
+			unref(emulnet.parts[i][j]);
+		}
+		emulnet.readpos[i] = 0;
+		emulnet.parts[i].clear();
+		emulnet.mailbox[i].clear();
 	}
+	for ( i = 0; i < (int)emulnet.outbox.size(); i++ ) {
+		for ( j = 0; j < (int)emulnet.outparts[i].size(); j++ ) {
+			unref(emulnet.outparts[i][j]);
+		}
+		emulnet.outparts[i].clear();
+		emulnet.outbox[i].clear();
+	}
+	for ( i = 0; i < (int)emulnet.inflight.size(); i++ ) {
+		for ( j = 0; j < (int)emulnet.inflightparts[i].size(); j++ ) {
+			unref(emulnet.inflightparts[i][j]);
+		}
+		emulnet.inflightparts[i].clear();
+		emulnet.inflight[i].clear();
+	}
+	emulnet.currbuffsize = 0;
 
 	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
 		fprintf(file, "node %3d ", i);
 		sent_total = 0;
 		recv_total = 0;
 
+		NodeTraffic none;
+		NodeTraffic &counts = i < (int)traffic.size() ? traffic[i] : none;
+		int next = 0;
 		for (j = 0; j < par->getcurrtime(); j++) {
+			en_count c = { j, 0, 0 };
+			if ( next < (int)counts.ticks.size() && counts.ticks[next].time == j ) {
+				c = counts.ticks[next++];
+			}
 
-			sent_total += sent_msgs[i][j];
-			recv_total += recv_msgs[i][j];
+			sent_total += c.sent;
+			recv_total += c.recv;
 			if (i != 67) {
-				fprintf(file, " (%4d, %4d)", sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, " (%4d, %4d)", c.sent, c.recv);
 				if (j % 10 == 9) {
 					fprintf(file, "\n         ");
 				}
 			}
 			else {
-				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, "special %4d %4d %4d\n", j, c.sent, c.recv);
 			}
 		}
 		fprintf(file, "\n");
-		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_bytes %8ld  recv_bytes %8ld\n\n", i, counts.sent_bytes, counts.recv_bytes);
 	}
 
 	fclose(file);
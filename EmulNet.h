@@ -7,47 +7,126 @@
 #ifndef _EMULNET_H_
 #define _EMULNET_H_
 
-#define MAX_NODES 1000
-#define MAX_TIME 3600
+// Messages that may be buffered in the network at once, for groups of up to ENBUFFNODES
 #define ENBUFFSIZE 30000
+#define ENBUFFNODES 1000
+// Messages handed to an inbox at a time
+#define INBOX_DELIVER_BATCH 64
 
 #include "stdincludes.h"
+#include <atomic>
 #include "Params.h"
 #include "Member.h"
+#include "LinkModel.h"
+#include "MsgArena.h"
+#include "MsgTrace.h"
+#include "Random.h"
+#include "TickExecutor.h"
+#include "Trace.h"
+#include "Profiler.h"
 
 using namespace std;
 
+/**
+ * Struct Name: en_payload
+ *
+ * DESCRIPTION: Body of a sent message, followed by its size bytes. One copy is
+ * 				shared by every recipient and recycled when the last one releases it.
+ */
+typedef struct en_payload {
+	int size;
+	// Recipients that have not released the payload yet
+	atomic<int> refs;
+}en_payload;
+
 /**
  * Struct Name: en_msg
+ *
+ * DESCRIPTION: Envelope carrying the messages from one node to one destination in
+ * 				one tick. Its count payloads are kept next to it, in the parts of
+ * 				the outbox or mailbox holding it.
  */
 typedef struct en_msg {
-	// Number of bytes after the class
+	// Number of payload bytes carried
 	int size;
 	// Source node
-	Address from;
+	NodeId from;
 	// Destination node
-	Address to;
+	NodeId to;
+	// Number of payloads carried
+	int count;
+	// Tick the envelope was delivered to its mailbox in
+	int time;
 }en_msg;
 
+/**
+ * Struct Name: en_count
+ *
+ * DESCRIPTION: Messages sent and received by a node in one tick
+ */
+typedef struct en_count {
+	int time;
+	int sent;
+	int recv;
+}en_count;
+
+/**
+ * CLASS NAME: NodeTraffic
+ *
+ * DESCRIPTION: Message counts of one node. Only the ticks the node had traffic
+ * 				in are kept, in tick order, so memory follows the traffic rather
+ * 				than the group size times the run length.
+ */
+class NodeTraffic {
+public:
+	vector<en_count> ticks;
+	long sent_bytes;
+	long recv_bytes;
+	NodeTraffic(): sent_bytes(0), recv_bytes(0) {}
+	// Counts of the given tick, which is never earlier than the last one counted
+	en_count &at(int time) {
+		if ( ticks.empty() || ticks.back().time != time ) {
+			en_count c = { time, 0, 0 };
+			ticks.push_back(c);
+		}
+		return ticks.back();
+	}
+};
+
 /**
  * Class Name: EM
  */
 class EM {
 public:
 	int nextid;
+	// Number of messages buffered over all mailboxes
 	int currbuffsize;
 	int firsteltindex;
-	en_msg* buff[ENBUFFSIZE];
+	// Envelopes waiting for each node and their payloads, indexed by node id
+	vector< vector<en_msg> > mailbox;
+	vector< vector<en_payload*> > parts;
+	// Payloads at the front of each mailbox already handed over by ENrecv. The
+	// mailbox is cleared once they all are.
+	vector<int> readpos;
+	// Envelopes sent by each shard that are not in a mailbox yet, and their payloads
+	vector< vector<en_msg> > outbox;
+	vector< vector<en_payload*> > outparts;
+	// Messages still on their way, in a ring of slots by the tick they arrive at,
+	// one envelope per payload
+	vector< vector<en_msg> > inflight;
+	vector< vector<en_payload*> > inflightparts;
 	EM() {}
 	EM& operator = (EM &anotherEM) {
 		this->nextid = anotherEM.getNextId();
 		this->currbuffsize = anotherEM.getCurrBuffSize();
 		this->firsteltindex = anotherEM.getFirstEltIndex();
-		int i = this->currbuffsize;
-		while (i > 0) {
-			this->buff[i] = anotherEM.buff[i];
-			i--;
-		}
+		this->mailbox = anotherEM.mailbox;
+		this->parts = anotherEM.parts;
+		this->readpos = anotherEM.readpos;
+		this->outbox = anotherEM.outbox;
+		this->outparts = anotherEM.outparts;
+		this->inflight = anotherEM.inflight;
+		this->inflightparts = anotherEM.inflightparts;
 		return *this;
 	}
 	int getNextId() {
@@ -80,10 +159,40 @@ class EmulNet
 { 	
 private:
 	Params* par;
-	int sent_msgs[MAX_NODES + 1][MAX_TIME];
-	int recv_msgs[MAX_NODES + 1][MAX_TIME];
+	// Indexed by node id, kept as long as the mailboxes
+	vector<NodeTraffic> traffic;
+	// Nodes gone for good, messages to them are discarded
+	vector<char> closed;
+	int buffLimit;
+	// Messages sent over the whole run and those of them dropped
+	long sentTotal;
+	long droppedTotal;
+	// Envelopes delivered to the mailboxes over the whole run
+	long envelopesTotal;
+	// Largest payload sent
+	int maxMsgSize;
 	int enInited;
 	EM emulnet;
+	// Every en_payload lives in a slot of one of these, one arena per shard
+	vector<MsgArena *> arenas;
+	// Messages taken out of the mailboxes by each shard since the last flush
+	vector<int> received;
+	// Nodes whose mailbox went from empty to not empty since they were last taken
+	vector<int> ready;
+	// Draws the message drops
+	Random rng;
+	// When each message arrives, if at all
+	LinkModel *link;
+	// Trace the delivered messages are recorded to or replayed from, NULL for none
+	MsgTrace *msgTrace;
+	bool replaying;
+	void initShards();
+	void initTrace();
+	void addNode(int id);
+	en_payload *newPayload(char *data, int size, int refs);
+	void unref(en_payload *payload);
+	void deliver(int dst, en_msg &em, en_payload *payload, int now);
+	void arrive(int now);
 public:
  	EmulNet(Params *p);
  	EmulNet(EmulNet &anotherEmulNet);
@@ -92,8 +201,31 @@ public:
 	void *ENinit(Address *myaddr, short port);
 	int ENsend(Address *myaddr, Address *toaddr, string data);
 	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENsendv(Address *myaddr, Address *toaddrs, int n, char *data, int size);
+	int ENsendv(Address *myaddr, Address *toaddr, char **data, int *sizes, int n);
 	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	int ENrecv(Address *myaddr, Inbox *inbox);
+	void ENrelease(char *data);
+	void ENflush();
+	void ENtakeReady(vector<int> &ids);
+	void setLinkModel(LinkModel *model);
+	LinkModel *getLinkModel() {
+		return link;
+	}
+	void ENclose(Address *addr);
 	int ENcleanup();
+	long getSentTotal() {
+		return sentTotal;
+	}
+	long getDroppedTotal() {
+		return droppedTotal;
+	}
+	long getEnvelopesTotal() {
+		return envelopesTotal;
+	}
+	int getMaxMsgSize() {
+		return maxMsgSize;
+	}
 };
 
 #endif /* _EMULNET_H_ */
@@ -0,0 +1,145 @@
+/**********************************
+ * FILE NAME: Inbox.cpp
+ *
+ * DESCRIPTION: Definition of the lock-free inbox of a node
+ **********************************/
+
+#include "Inbox.h"
+
+/**
+ * Constructor
+ */
+Inbox::Inbox(int capacity): tail(0), head(0), slots(NULL), mask(0) {
+	resize(capacity);
+}
+
+/**
+ * Destructor
+ */
+Inbox::~Inbox() {
+	delete[] slots;
+}
+
+/**
+ * FUNCTION NAME: resize
+ *
+ * DESCRIPTION: Hold up to capacity messages, rounded up to a power of two and at
+ * 				least two, as with one slot a filled slot would look free for the
+ * 				next lap. Only while nothing is pushed or taken; messages in the
+ * 				ring are lost.
+ */
+void Inbox::resize(int capacity) {
+	uint32_t size = 2;
+	while ( (int)size < capacity ) {
+		size <<= 1;
+	}
+	delete[] slots;
+	slots = new Slot[size];
+	mask = size - 1;
+	for ( uint32_t pos = 0; pos < size; pos++ ) {
+		slots[pos].seq.store(pos, memory_order_relaxed);
+	}
+	head = 0;
+	tail.store(0, memory_order_release);
+}
+
+/**
+ * FUNCTION NAME: push
+ *
+ * DESCRIPTION: Append a message, from any thread. Returns false, keeping nothing,
+ * 				if the inbox is full; the caller still owns the message then.
+ */
+bool Inbox::push(char *data, int size) {
+	uint32_t pos = tail.load(memory_order_relaxed);
+	Slot *slot;
+	for ( ;; ) {
+		slot = &slots[pos & mask];
+		int32_t lag = (int32_t)(slot->seq.load(memory_order_acquire) - pos);
+		if ( lag == 0 ) {
+			// The slot is free for pos, claim it unless another producer did
+			if ( tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed) ) {
+				break;
+			}
+		}
+		else if ( lag < 0 ) {
+			// The slot still holds the message of the previous lap
+			return false;
+		}
+		else {
+			pos = tail.load(memory_order_relaxed);
+		}
+	}
+	slot->data = data;
+	slot->size = size;
+	slot->seq.store(pos + 1, memory_order_release);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: push
+ *
+ * DESCRIPTION: Append up to n messages in order, from any thread, claiming their
+ * 				slots at once. Returns the number appended, fewer than n if the
+ * 				inbox filled up; the caller still owns the rest.
+ */
+int Inbox::push(const InboxMsg *msgs, int n) {
+	uint32_t pos = tail.load(memory_order_relaxed);
+	int count;
+	for ( ;; ) {
+		// The consumer frees slots in order, so the free ones from pos on are consecutive
+		count = 0;
+		while ( count < n && slots[(pos + count) & mask].seq.load(memory_order_acquire) == pos + count ) {
+			count++;
+		}
+		if ( count == 0 ) {
+			int32_t lag = (int32_t)(slots[pos & mask].seq.load(memory_order_acquire) - pos);
+			if ( lag < 0 ) {
+				return 0;
+			}
+			pos = tail.load(memory_order_relaxed);
+			continue;
+		}
+		if ( tail.compare_exchange_weak(pos, pos + count, memory_order_relaxed) ) {
+			break;
+		}
+	}
+	for ( int i = 0; i < count; i++ ) {
+		Slot &slot = slots[(pos + i) & mask];
+		slot.data = msgs[i].data;
+		slot.size = msgs[i].size;
+		slot.seq.store(pos + i + 1, memory_order_release);
+	}
+	return count;
+}
+
+/**
+ * FUNCTION NAME: drain
+ *
+ * DESCRIPTION: Take up to max messages into out, oldest first, from the consumer
+ * 				thread only. Returns the number taken, 0 if the inbox is empty.
+ */
+int Inbox::drain(InboxMsg *out, int max) {
+	int n = 0;
+	while ( n < max ) {
+		Slot &slot = slots[head & mask];
+		if ( slot.seq.load(memory_order_acquire) != head + 1 ) {
+			break;
+		}
+		out[n].data = slot.data;
+		out[n].size = slot.size;
+		n++;
+		// Free the slot for the push one lap on
+		slot.seq.store(head + mask + 1, memory_order_release);
+		head++;
+	}
+	return n;
+}
+
+/**
+ * FUNCTION NAME: empty
+ *
+ * DESCRIPTION: Whether there is nothing to take, as seen by the consumer
+ */
+bool Inbox::empty() {
+	return slots[head & mask].seq.load(memory_order_acquire) != head + 1;
+}
@@ -0,0 +1,77 @@
+/**********************************
+ * FILE NAME: Inbox.h
+ *
+ * DESCRIPTION: Bounded lock-free queue of the messages delivered to a node
+ **********************************/
+
+#ifndef _INBOX_H_
+#define _INBOX_H_
+
+#include "stdincludes.h"
+#include <atomic>
+
+/*
+ * Macros
+ */
+// Bytes the producer and consumer counters are kept apart by, so they never share a cache line
+#define INBOX_CACHE_LINE 64
+// Messages an inbox holds unless sized otherwise
+#define INBOX_DEFAULT_SIZE 64
+
+/**
+ * Struct Name: InboxMsg
+ *
+ * DESCRIPTION: Handle of a message in an inbox. The payload is not copied:
+ * 				whoever takes the handle out of the inbox owns it, and must
+ * 				hand the payload back to the network once done with it.
+ */
+typedef struct InboxMsg {
+	char *data;
+	int size;
+}InboxMsg;
+
+/**
+ * CLASS NAME: Inbox
+ *
+ * DESCRIPTION: Ring of message handles any number of threads may push into
+ * 				and one thread takes them out of, in the order they were pushed.
+ * 				A producer claims a slot with a compare and swap on the tail,
+ * 				fills it and publishes it through the slot's sequence number;
+ * 				the consumer takes the slots it sees published without any
+ * 				read-modify-write. Nothing is allocated once the ring is sized,
+ * 				and a push into a full ring fails rather than waits.
+ */
+class Inbox {
+private:
+	typedef struct Slot {
+		// Position the slot is next filled for, plus one once it is filled
+		atomic<uint32_t> seq;
+		int size;
+		char *data;
+	}Slot;
+	char padFront[INBOX_CACHE_LINE];
+	// Next position to push to, shared by the producers
+	atomic<uint32_t> tail;
+	char padTail[INBOX_CACHE_LINE - sizeof(atomic<uint32_t>)];
+	// Next position to take from, the consumer's own
+	uint32_t head;
+	char padHead[INBOX_CACHE_LINE - sizeof(uint32_t)];
+	Slot *slots;
+	uint32_t mask;
+public:
+	Inbox(int capacity = INBOX_DEFAULT_SIZE);
+	virtual ~Inbox();
+	void resize(int capacity);
+	bool push(char *data, int size);
+	int push(const InboxMsg *msgs, int n);
+	int drain(InboxMsg *out, int max);
+	bool empty();
+	int capacity() {
+		return (int)mask + 1;
+	}
+private:
+	Inbox(const Inbox &anotherInbox);
+	Inbox& operator =(const Inbox &anotherInbox);
+};
+
+#endif /* _INBOX_H_ */
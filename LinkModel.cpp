@@ -0,0 +1,133 @@
+/**********************************
+ * FILE NAME: LinkModel.cpp
+ *
+ * DESCRIPTION: Definition of the default link model of the emulated network
+ **********************************/
+
+#include "LinkModel.h"
+
+/**
+ * Constructor
+ */
+LinkModel::LinkModel(Params *par): par(par), partitionDrops(0), burstDrops(0), queueDrops(0), queued(0), queueTicks(0) {}
+
+/**
+ * FUNCTION NAME: addNode
+ *
+ * DESCRIPTION: Make room for the link state of node id
+ */
+void LinkModel::addNode(int id) {
+	if ( id >= (int)busy.size() ) {
+		busy.resize(id + 1, 0);
+		bad.resize(id + 1, 0);
+	}
+}
+
+/**
+ * FUNCTION NAME: route
+ *
+ * DESCRIPTION: Send a message of size bytes from src to dst in tick now. Returns the
+ * 				ticks it arrives after the next one, or LINK_DROPPED if it is lost.
+ * 				Draws from rng only for the features turned on.
+ */
+int LinkModel::route(int src, int dst, int size, int now, Random &rng) {
+	if ( partitioned(src, dst, now) ) {
+		partitionDrops++;
+		return LINK_DROPPED;
+	}
+
+	if ( par->LOSS_BURST_ENTER > 0 ) {
+		addNode(src);
+		bad[src] = bad[src] ? !chance(par->LOSS_BURST_EXIT, rng) : chance(par->LOSS_BURST_ENTER, rng);
+		if ( bad[src] && chance(par->LOSS_BURST_DROP, rng) ) {
+			burstDrops++;
+			return LINK_DROPPED;
+		}
+	}
+
+	int delay = par->LATENCY + pairLatency(src, dst) + jitter(rng);
+
+	// The uplink sends the messages of its node one after the other, those that
+	// do not fit in this tick go out in the next ones
+	if ( par->BANDWIDTH > 0 ) {
+		addNode(src);
+		long done = max(busy[src], (long)now * par->BANDWIDTH) + size;
+		int wait = max(0, (int)((done - 1) / par->BANDWIDTH) - now);
+		if ( wait > par->BANDWIDTH_QUEUE ) {
+			queueDrops++;
+			return LINK_DROPPED;
+		}
+		busy[src] = done;
+		if ( wait > 0 ) {
+			queued++;
+			queueTicks += wait;
+		}
+		delay += wait;
+	}
+	return delay;
+}
+
+/**
+ * FUNCTION NAME: partitioned
+ *
+ * DESCRIPTION: Whether a partition keeps src and dst apart in tick now
+ */
+bool LinkModel::partitioned(int src, int dst, int now) {
+	for ( int i = 0; i < (int)par->PARTITIONS.size(); i++ ) {
+		Partition &p = par->PARTITIONS[i];
+		if ( now >= p.start && now < p.end
+			 && (src >= p.lo && src <= p.hi) != (dst >= p.lo && dst <= p.hi) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * FUNCTION NAME: maxDelay
+ *
+ * DESCRIPTION: Most ticks route() can return
+ */
+int LinkModel::maxDelay() {
+	return par->LATENCY + par->LATENCY_SPREAD + par->LATENCY_JITTER + (par->BANDWIDTH > 0 ? par->BANDWIDTH_QUEUE : 0);
+}
+
+/**
+ * FUNCTION NAME: pairLatency
+ *
+ * DESCRIPTION: Extra latency of the pair src, dst: the same both ways and for the
+ * 				whole run, hashed from the pair and the seed rather than stored
+ */
+int LinkModel::pairLatency(int src, int dst) {
+	if ( par->LATENCY_SPREAD == 0 ) {
+		return 0;
+	}
+	uint64_t pair = ((uint64_t)(uint32_t)min(src, dst) << 32) | (uint32_t)max(src, dst);
+	return (int)(Random::mix(pair ^ par->SEED) % (par->LATENCY_SPREAD + 1));
+}
+
+/**
+ * FUNCTION NAME: jitter
+ *
+ * DESCRIPTION: Extra latency of one message, up to LATENCY_JITTER. The exponential
+ * 				distribution has most messages quick and a long tail.
+ */
+int LinkModel::jitter(Random &rng) {
+	if ( par->LATENCY_JITTER == 0 ) {
+		return 0;
+	}
+	if ( par->LATENCY_DIST == UNIFORM_LATENCY ) {
+		return rng() % (par->LATENCY_JITTER + 1);
+	}
+	double u = (rng() + 0.5) / 4294967296.0;
+	return min(par->LATENCY_JITTER, (int)(-par->LATENCY_JITTER / 4.0 * log(u)));
+}
+
+/**
+ * FUNCTION NAME: chance
+ *
+ * DESCRIPTION: True with probability p
+ */
+bool LinkModel::chance(double p, Random &rng) {
+	return rng() < p * 4294967296.0;
+}
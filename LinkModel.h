@@ -0,0 +1,80 @@
+/**********************************
+ * FILE NAME: LinkModel.h
+ *
+ * DESCRIPTION: Latency, bandwidth, loss and partitions of the emulated network
+ **********************************/
+
+#ifndef _LINKMODEL_H_
+#define _LINKMODEL_H_
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Random.h"
+
+/*
+ * Macros
+ */
+// route() result of a message the link loses
+#define LINK_DROPPED -1
+
+/**
+ * CLASS NAME: LinkModel
+ *
+ * DESCRIPTION: Decides, message by message, when a message sent by one node
+ * 				arrives at another, or that it never does. The default model
+ * 				takes its links from the parameters:
+ * 					latency: LATENCY ticks, plus up to LATENCY_SPREAD more that
+ * 					are fixed per pair of nodes, plus up to LATENCY_JITTER more
+ * 					drawn per message;
+ * 					bandwidth: each node sends BANDWIDTH bytes per tick, the
+ * 					rest waits for its link, or is dropped after BANDWIDTH_QUEUE
+ * 					ticks of waiting;
+ * 					bursty loss: a two state chain per sender, whose bad state
+ * 					loses LOSS_BURST_DROP of the messages;
+ * 					partitions: the PARTITION windows.
+ * 				Per node state is a few bytes, and nothing is kept per pair,
+ * 				so the model stays cheap at thousands of nodes. Subclass it and
+ * 				hand it to EmulNet::setLinkModel for another network.
+ * 				Called by EmulNet::ENflush only, not thread safe.
+ */
+class LinkModel {
+protected:
+	Params *par;
+	// Byte clock of the uplink of each node id: the link is busy until busy / BANDWIDTH
+	vector<long> busy;
+	// Whether the link of each node id is in the bad state of the loss chain
+	vector<char> bad;
+	// Messages lost to each cause and messages that waited for a link
+	long partitionDrops;
+	long burstDrops;
+	long queueDrops;
+	long queued;
+	long queueTicks;
+	void addNode(int id);
+	int pairLatency(int src, int dst);
+	int jitter(Random &rng);
+	bool chance(double p, Random &rng);
+public:
+	LinkModel(Params *par);
+	virtual ~LinkModel() {}
+	virtual int route(int src, int dst, int size, int now, Random &rng);
+	virtual bool partitioned(int src, int dst, int now);
+	virtual int maxDelay();
+	long getPartitionDrops() {
+		return partitionDrops;
+	}
+	long getBurstDrops() {
+		return burstDrops;
+	}
+	long getQueueDrops() {
+		return queueDrops;
+	}
+	long getQueued() {
+		return queued;
+	}
+	long getQueueTicks() {
+		return queueTicks;
+	}
+};
+
+#endif /* _LINKMODEL_H_ */
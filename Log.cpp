@@ -6,12 +6,29 @@
 
 #include "Log.h"
 
+// dbg.log and stats.log, opened by the first LOG
+static FILE *fp;
+static FILE *fp2;
+// dbg.bin, opened by the first event when LOG_FORMAT is binary
+static BinLogWriter *binlog;
+
+/**
+ * FUNCTION NAME: closeBinLog
+ *
+ * DESCRIPTION: Write out the events still queued and close dbg.bin at exit
+ */
+static void closeBinLog() {
+	delete binlog;
+	binlog = NULL;
+}
+
 /**
  * Constructor
  */
 Log::Log(Params *p) {
 	par = p;
 	firstTime = false;
+	staging = false;
 }
 
 /**
@@ -20,6 +37,10 @@ Log::Log(Params *p) {
 Log::Log(const Log &anotherLog) {
 	this->par = anotherLog.par;
 	this->firstTime = anotherLog.firstTime;
+	this->staging = anotherLog.staging;
+	this->stagedDbg = anotherLog.stagedDbg;
+	this->stagedStats = anotherLog.stagedStats;
+	this->stagedRecs = anotherLog.stagedRecs;
 }
 
 /**
@@ -28,6 +49,10 @@ Log::Log(const Log &anotherLog) {
 Log& Log::operator = (const Log& anotherLog) {
 	this->par = anotherLog.par;
 	this->firstTime = anotherLog.firstTime;
+	this->staging = anotherLog.staging;
+	this->stagedDbg = anotherLog.stagedDbg;
+	this->stagedStats = anotherLog.stagedStats;
+	this->stagedRecs = anotherLog.stagedRecs;
 	return *this;
 }
 
@@ -40,15 +65,36 @@ Log::~Log() {}
  * FUNCTION NAME: LOG
  *
  * DESCRIPTION: Print out to file dbg.log, along with Address of node.
+ * 				While staging, the line is kept in the buffer of the calling shard
+ * 				until flushStaged instead.
  */
 void Log::LOG(Address *addr, const char * str, ...) {
 
-	static FILE *fp;
-	static FILE *fp2;
 	va_list vararglist;
-	static char buffer[30000];
+	char buffer[30000];
+
+	if ( par->LOG_FORMAT == NO_LOG ) {
+		return;
+	}
+	if ( par->LOG_FORMAT == BINARY_LOG ) {
+		va_start(vararglist, str);
+		vsnprintf(buffer, sizeof(buffer), str, vararglist);
+		va_end(vararglist);
+
+		int type = memcmp(buffer, "#STATSLOG#", 10) == 0 ? LOG_EV_STATS : LOG_EV_TEXT;
+		if ( staging ) {
+			BinLogWriter::makeText(stagedRecs[TickExecutor::currentShard()], par->getcurrtime(), addr->addr, type, buffer);
+		}
+		else {
+			BinLogWriter::makeText(textRecs, par->getcurrtime(), addr->addr, type, buffer);
+			writeRecords(&textRecs[0], (int)textRecs.size());
+			textRecs.clear();
+		}
+		return;
+	}
+
 	static int numwrites;
-	static char stdstring[30];
+	char stdstring[30] = "";
 	static char stdstring2[40];
 	static char stdstring3[40]; 
 	static int dbg_opened=0;
@@ -73,7 +119,7 @@ void Log::LOG(Address *addr, const char * str, ...) {
 	sprintf(stdstring, "%d.%d.%d.%d:%d ", addr->addr[0], addr->addr[1], addr->addr[2], addr->addr[3], *(short *)&addr->addr[4]);
 
 	va_start(vararglist, str);
-	vsprintf(buffer, str, vararglist);
+	vsnprintf(buffer, sizeof(buffer), str, vararglist);
 	va_end(vararglist);
 
 	if (!firstTime) {
@@ -87,16 +133,28 @@ void Log::LOG(Address *addr, const char * str, ...) {
 		firstTime = true;
 	}
 
-	if(memcmp(buffer, "#STATSLOG#", 10)==0){
+	bool stats = memcmp(buffer, "#STATSLOG#", 10) == 0;
+
+	if (staging) {
+		char line[64];
+		int shard = TickExecutor::currentShard();
+		string &out = stats ? stagedStats[shard] : stagedDbg[shard];
+		snprintf(line, sizeof(line), "\n %s[%d] ", stdstring, par->getcurrtime());
+		out += line;
+		out += buffer;
+		return;
+	}
+
+	if(stats){
 		fprintf(fp2, "\n %s", stdstring);
 		fprintf(fp2, "[%d] ", par->getcurrtime());
 
-		fprintf(fp2, buffer);
+		fprintf(fp2, "%s", buffer);
 	}
 	else{
 		fprintf(fp, "\n %s", stdstring);
 		fprintf(fp, "[%d] ", par->getcurrtime());
-		fprintf(fp, buffer);
+		fprintf(fp, "%s", buffer);
 
 	}
 
@@ -108,15 +166,87 @@ void Log::LOG(Address *addr, const char * str, ...) {
 
 }
 
+/**
+ * FUNCTION NAME: beginStaging
+ *
+ * DESCRIPTION: Buffer the lines logged by each of shards threads until flushStaged,
+ * 				so parallel shards do not share the files
+ */
+void Log::beginStaging(int shards) {
+	stagedDbg.resize(shards);
+	stagedStats.resize(shards);
+	stagedRecs.resize(shards);
+	staging = true;
+}
+
+/**
+ * FUNCTION NAME: flushStaged
+ *
+ * DESCRIPTION: Write out the staged lines and stop staging. Shards are written from the
+ * 				last to the first, the order a single thread logs the nodes in.
+ */
+void Log::flushStaged() {
+	staging = false;
+	if ( par->LOG_FORMAT == BINARY_LOG ) {
+		for ( int shard = (int)stagedRecs.size() - 1; shard >= 0; shard-- ) {
+			if ( !stagedRecs[shard].empty() ) {
+				writeRecords(&stagedRecs[shard][0], (int)stagedRecs[shard].size());
+			}
+			stagedRecs[shard].clear();
+		}
+		return;
+	}
+	for ( int shard = (int)stagedDbg.size() - 1; shard >= 0; shard-- ) {
+		fputs(stagedDbg[shard].c_str(), fp);
+		fputs(stagedStats[shard].c_str(), fp2);
+		stagedDbg[shard].clear();
+		stagedStats[shard].clear();
+	}
+	fflush(fp);
+	fflush(fp2);
+}
+
+/**
+ * FUNCTION NAME: writeRecords
+ *
+ * DESCRIPTION: Queue binary log records for the background writer, or keep them
+ * 				with the calling shard while staging
+ */
+void Log::writeRecords(const LogRecord *recs, int n) {
+	if ( staging ) {
+		vector<LogRecord> &out = stagedRecs[TickExecutor::currentShard()];
+		out.insert(out.end(), recs, recs + n);
+		return;
+	}
+	if ( binlog == NULL ) {
+		binlog = new BinLogWriter(DBG_BIN);
+		atexit(closeBinLog);
+	}
+	for ( int i = 0; i < n; i++ ) {
+		binlog->write(recs[i]);
+	}
+}
+
 /**
  * FUNCTION NAME: logNodeAdd
  *
  * DESCRIPTION: To Log a node add
  */
-void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
-	static char stdstring[100];
-	sprintf(stdstring, "Node %d.%d.%d.%d:%d joined at time %d", addedAddr->addr[0], addedAddr->addr[1], addedAddr->addr[2], addedAddr->addr[3], *(short *)&addedAddr->addr[4], par->getcurrtime());
-    LOG(thisNode, stdstring);
+void Log::logNodeAdd(Address *thisNode, NodeId node) {
+	if ( par->LOG_FORMAT == NO_LOG ) {
+		return;
+	}
+	char peer[6];
+	node.toBytes(peer);
+	if ( par->LOG_FORMAT == BINARY_LOG ) {
+		LogRecord rec;
+		BinLogWriter::makeEvent(rec, par->getcurrtime(), thisNode->addr, LOG_EV_ADD, peer);
+		writeRecords(&rec, 1);
+		return;
+	}
+	char stdstring[100];
+	sprintf(stdstring, "Node %d.%d.%d.%d:%d joined at time %d", peer[0], peer[1], peer[2], peer[3], node.getport(), par->getcurrtime());
+    LOG(thisNode, "%s", stdstring);
 }
 
 /**
@@ -124,8 +254,19 @@ void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
  *
  * DESCRIPTION: To log a node remove
  */
-void Log::logNodeRemove(Address *thisNode, Address *removedAddr) {
-	static char stdstring[30];
-	sprintf(stdstring, "Node %d.%d.%d.%d:%d removed at time %d", removedAddr->addr[0], removedAddr->addr[1], removedAddr->addr[2], removedAddr->addr[3], *(short *)&removedAddr->addr[4], par->getcurrtime());
-    LOG(thisNode, stdstring);
+void Log::logNodeRemove(Address *thisNode, NodeId node) {
+	if ( par->LOG_FORMAT == NO_LOG ) {
+		return;
+	}
+	char peer[6];
+	node.toBytes(peer);
+	if ( par->LOG_FORMAT == BINARY_LOG ) {
+		LogRecord rec;
+		BinLogWriter::makeEvent(rec, par->getcurrtime(), thisNode->addr, LOG_EV_REMOVE, peer);
+		writeRecords(&rec, 1);
+		return;
+	}
+	char stdstring[100];
+	sprintf(stdstring, "Node %d.%d.%d.%d:%d removed at time %d", peer[0], peer[1], peer[2], peer[3], node.getport(), par->getcurrtime());
+    LOG(thisNode, "%s", stdstring);
 }
@@ -10,6 +10,8 @@
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "TickExecutor.h"
+#include "BinLog.h"
 
 /*
  * Macros
@@ -19,6 +21,8 @@
 #define MAGIC_NUMBER "CS425"
 #define DBG_LOG "dbg.log"
 #define STATS_LOG "stats.log"
+// Written instead of both text logs when LOG_FORMAT is binary
+#define DBG_BIN "dbg.bin"
 
 /**
  * CLASS NAME: Log
@@ -29,14 +33,24 @@ class Log{
 private:
 	Params *par;
 	bool firstTime;
+	// Lines logged by each shard while the simulation runs in parallel
+	bool staging;
+	vector<string> stagedDbg;
+	vector<string> stagedStats;
+	vector< vector<LogRecord> > stagedRecs;
+	// Records of one text line, when LOG_FORMAT is binary
+	vector<LogRecord> textRecs;
+	void writeRecords(const LogRecord *recs, int n);
 public:
 	Log(Params *p);
 	Log(const Log &anotherLog);
 	Log& operator = (const Log &anotherLog);
 	virtual ~Log();
 	void LOG(Address *, const char * str, ...);
-	void logNodeAdd(Address *, Address *);
-	void logNodeRemove(Address *, Address *);
+	void logNodeAdd(Address *, NodeId);
+	void logNodeRemove(Address *, NodeId);
+	void beginStaging(int shards);
+	void flushStaged();
 };
 
 #endif /* _LOG_H_ */
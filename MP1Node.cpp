@@ -16,46 +16,68 @@
  * is necessary for your logic to work
  */
 MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
-    for( int i = 0; i < 6; i++ ) {
-        NULLADDR[i] = 0;
-    }
     this->memberNode = member;
     this->emulNet = emul;
     this->log = log;
     this->par = params;
     this->memberNode->addr = *address;
+    // Largest payload EmulNet will accept
+    this->sendBuffSize = par->MAX_MSG_SIZE - (int)sizeof(en_msg) - 1;
+    this->sendBuff = new char[sendBuffSize];
+    // Each node draws from its own stream of the run's seed
+    this->rng.seed(par->SEED, RNG_STREAM_NODE + address->getid());
+    this->gossipInterval = par->GOSSIP_INTERVAL > 0 ? par->GOSSIP_INTERVAL : GOSSIP_INTERVAL_START;
+    this->nextGossip = gossipInterval;
+    this->gossipHeard = 0;
+    //Start from more than any round could bring, so the loss estimate starts at none
+    this->gossipRate = 1;
+    this->gossipLastFanout = 0;
+    this->nearMisses = 0;
+    this->antiEntropyRounds = 0;
+    this->calmRounds = 0;
+    this->probeTarget = -1;
+    this->probeSeq = 0;
+    this->probeStart = -SWIM_PERIOD;
+    this->probeAcked = false;
+    this->probeIndirect = false;
+    this->swimTop = 0;
+    this->targetNext = 0;
+    this->pickRound = 0;
+    this->lastOps = -1;
+    this->wakeTick = 0;
+    this->recvWaiting = 0;
+    if (memberNode->inbox.capacity() != par->INBOX_SIZE) {
+        memberNode->inbox.resize(par->INBOX_SIZE);
+    }
+    ZoneSummary none = { 0, 0, false, 0, 0 };
+    this->zoneReps.assign(par->zoneCount(), none);
 }
 
 /**
  * Destructor of the MP1Node class
  */
-MP1Node::~MP1Node() {}
+MP1Node::~MP1Node() {
+    delete[] sendBuff;
+}
 
 /**
  * FUNCTION NAME: recvLoop
  *
- * DESCRIPTION: This function receives message from the network and pushes into the queue
+ * DESCRIPTION: This function receives message from the network and pushes into the inbox
  * 				This function is called by a node to receive messages currently waiting for it
+ * 				Returns the messages the inbox had no room for
  */
 int MP1Node::recvLoop() {
+    ProfileScope profile(PHASE_RECV_LOOP);
     if ( memberNode->bFailed ) {
         return false;
     }
     else {
-        return emulNet->ENrecv(&(memberNode->addr), enqueueWrapper, NULL, 1, &(memberNode->mp1q));
+        recvWaiting = emulNet->ENrecv(&(memberNode->addr), &(memberNode->inbox));
+        return recvWaiting;
     }
 }
 
-/**
- * FUNCTION NAME: enqueueWrapper
- *
- * DESCRIPTION: Enqueue the message from Emulnet into the queue
- */
-int MP1Node::enqueueWrapper(void *env, char *buff, int size) {
-    Queue q;
-    return q.enqueue((queue<q_elt> *)env, (void *)buff, size);
-}
-
 /**
  * FUNCTION NAME: nodeStart
  *
@@ -83,6 +105,7 @@ void MP1Node::nodeStart(char *servaddrstr, short servport) {
         exit(1);
     }
 
+    wakeTick = par->globaltime + 1;
     return;
 }
 
@@ -107,6 +130,11 @@ int MP1Node::initThisNode(Address *joinaddr) {
     memberNode->pingCounter = 1;
     memberNode->timeOutCounter = -1;
     initMemberListTable(memberNode);
+    //TIMEOUTS wheel keeps a timer per member rather than sweeping the table. Only for
+    //the gossip detector, the suspicion timeout of SWIM follows the size of the group.
+    if (par->DETECTOR == GOSSIP_DETECTOR && par->TIMEOUTS == WHEEL_TIMEOUTS) {
+        memberNode->memberList.setTimeouts(TFAIL, TFAIL + suspectTimeout(), par->TOMBSTONE_TTL);
+    }
 
     return 0;
 }
@@ -122,30 +150,25 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
     //static char s[1024];
 #endif
 
-    if ( 0 == memcmp((char *)&(memberNode->addr.addr), (char *)&(joinaddr->addr), sizeof(memberNode->addr.addr))) {
+    if (memberNode->addr.nodeId() == joinaddr->nodeId()) {
         // I am the group booter (first process to join the group). Boot up the group
 #ifdef DEBUGLOG
         log->LOG(&memberNode->addr, "Starting up group...");
 #endif
+        memberNode->myPos = memberNode->memberList.insert(MemberListEntry(memberNode->addr.getid(), memberNode->addr.getport(),
+                                                                          memberNode->heartbeat, par->globaltime));
         memberNode->inGroup = true;
     }
     else {
-        string joinStr = "0";
-        joinStr = joinStr + ',' + memberNode->addr.getAddress() + ',' + to_string(memberNode->heartbeat);
-        //char *msg = new char[joinStr.size() + 1];
-        //copy(joinStr.begin(), joinStr.end(), msg);
-        //msg[joinStr.size()] = '\0'; // don't forget the terminating 0
-        char * msg = strdup(joinStr.c_str());
-        int msgsize = (int)joinStr.size()+1;
+        MessageWriter joinReq(sendBuff, sendBuffSize, JOINREQ);
+        joinReq.append(memberNode->addr.getid(), memberNode->addr.getport(), memberNode->heartbeat);
 #ifdef DEBUGLOG
         //sprintf(s, "Trying to join...");
         //log->LOG(&memberNode->addr, s);
 #endif
 
         // send JOINREQ message to introducer member
-        emulNet->ENsend(&memberNode->addr, joinaddr, msg, msgsize);
-
-        //delete[]msg;
+        emulNet->ENsend(&memberNode->addr, joinaddr, sendBuff, joinReq.size());
     }
 
     return 1;
@@ -178,17 +201,30 @@ int MP1Node::finishUpThisNode(){
  *
  * DESCRIPTION: Executed periodically at each member
  * 				Check your messages in queue and perform membership protocol duties
+ * 				The event scheduler only runs a node at the ticks it has messages or
+ * 				wakeTick comes up; the result is the same as running it every tick.
  */
 void MP1Node::nodeLoop() {
     if (memberNode->bFailed) {
         return;
     }
 
+    // Do the per tick duties of the ticks skipped since the last run
+    catchUp();
+
     // Check my messages
     checkMessages();
 
-    // Wait until you're in the group...
+    // Wait until you're in the group... only a JOINREP gets a joiner in
     if( !memberNode->inGroup ) {
+        wakeTick = INT_MAX;
+        return;
+    }
+
+    // Run for the messages alone, no timer is due yet. Nothing they brought
+    // times out sooner than the horizon.
+    if (par->SCHEDULER == EVENT_SCHEDULER && lastOps >= 0 && par->globaltime < wakeTick) {
+        wakeTick = min(wakeTick, par->globaltime + wakeHorizon());
         return;
     }
 
@@ -198,21 +234,75 @@ void MP1Node::nodeLoop() {
     return;
 }
 
+/**
+ * FUNCTION NAME: catchUp
+ *
+ * DESCRIPTION: Bring the node to the end of the last tick, doing what nodeLoopOps does
+ * 				on every tick for the ticks since lastOps: the heartbeat, the average of
+ * 				the gossip heard and the ping counter move on. Gossip heard in a tick
+ * 				with no nodeLoopOps is averaged in at that tick, as catchUp always runs
+ * 				before the messages of the next one.
+ */
+void MP1Node::catchUp() {
+    int now = par->globaltime;
+    if (lastOps < 0 || lastOps >= now - 1) {
+        return;
+    }
+    if (par->DETECTOR == GOSSIP_DETECTOR) {
+        int skipped = now - 1 - lastOps;
+        for (int t = 0; t < skipped; t++) {
+            gossipRate += GOSSIP_RATE_WEIGHT * (gossipHeard - gossipRate);
+            gossipHeard = 0;
+        }
+        int myLoc = memberNode->myPos;
+        memberNode->heartbeat += skipped;
+        memberNode->memberList[myLoc].setheartbeat(memberNode->heartbeat);
+        memberNode->memberList[myLoc].settimestamp(now - 1);
+        memberNode->memberList.touch(myLoc);
+        memberNode->pingCounter += skipped;
+    }
+    lastOps = now - 1;
+}
+
+/**
+ * FUNCTION NAME: wakeHorizon
+ *
+ * DESCRIPTION: Fewest ticks from now until a member added or refreshed now can time
+ * 				out, be removed, or be forgotten
+ */
+int MP1Node::wakeHorizon() {
+    int timeout = suspectTimeout();
+    if (par->DETECTOR == SWIM_DETECTOR) {
+        return 1 + min(timeout, par->TOMBSTONE_TTL);
+    }
+    return 1 + min(TFAIL + timeout, par->TOMBSTONE_TTL);
+}
+
 /**
  * FUNCTION NAME: checkMessages
  *
- * DESCRIPTION: Check messages in the queue and call the respective message handler
+ * DESCRIPTION: Check messages in the inbox and call the respective message handler
  */
 void MP1Node::checkMessages() {
-    void *ptr;
-    int size;
-
-    // Pop waiting messages from memberNode's mp1q
-    while ( !memberNode->mp1q.empty() ) {
-        ptr = memberNode->mp1q.front().elt;
-        size = memberNode->mp1q.front().size;
-        memberNode->mp1q.pop();
-        recvCallBack((void *)memberNode, (char *)ptr, size);
+    ProfileScope profile(PHASE_CHECK_MESSAGES);
+    InboxMsg batch[INBOX_BATCH];
+
+    // Take waiting messages from memberNode's inbox, a batch at a time
+    for ( ;; ) {
+        int n = memberNode->inbox.drain(batch, INBOX_BATCH);
+        if ( n == 0 ) {
+            // Once it is empty, receive the messages it had no room for
+            if ( recvWaiting == 0 ) {
+                break;
+            }
+            recvWaiting = emulNet->ENrecv(&(memberNode->addr), &(memberNode->inbox));
+            continue;
+        }
+        for ( int i = 0; i < n; i++ ) {
+            recvCallBack((void *)memberNode, batch[i].data, batch[i].size);
+            // The message is read in place, hand its slot back to the network
+            emulNet->ENrelease(batch[i].data);
+        }
     }
     return;
 }
@@ -224,109 +314,101 @@ void MP1Node::checkMessages() {
  */
 bool MP1Node::recvCallBack(void *env, char *data, int size ) {
 
-    //Rebuild data string, then split into vector elements.
-    string callBackData(data);
-    vector<string> dataVec;
-    split(callBackData, ',', dataVec);
-
-    int requestType = stoi(dataVec[0]);
-    //long timestamp = (long) time(NULL);
+    //Decode the header in place, entries are read out one at a time.
+    MessageReader reader(data, size);
+    if (!reader.valid()) {
+        return 0;
+    }
+    MemberListEntry mle;
 
-    if (requestType == 0) {
+    if (reader.getType() == JOINREQ && reader.getcount() > 0) {
         //JOINREQ
-        //Add node to memberlist and return memberlist in char array.
-        cout << "                Processing JOINREQ on node: ";
-        printAddress(&memberNode->addr);
-        cout << "JOINREQ msgsize: " << size << endl;
-        cout<<"JoinReqString: "<<callBackData<<endl;
-        //Set incoming node variables from vector
-        Address addr(dataVec[1]);
-        long heartbeat = stol(dataVec[2]);
-
-        //Clear the dataVec vector since we don't need it anymore
-        dataVec.clear();
-
-        cout << "Joiner Address: ";
-        printAddress(&addr);
-
-        //If memberlist is empty, add yourself.
-        if (memberNode->memberList.size() == 0) {
-            MemberListEntry *IntroMLE = new MemberListEntry((int) memberNode->addr.addr[0],
-                                                            (short) memberNode->addr.addr[4], memberNode->heartbeat,
-                                                            par->globaltime);
-            memberNode->memberList.push_back(*IntroMLE);
-            memberNode->myPos = memberNode->memberList.begin();
-        }
-
-        //Build MLE from joiner data
-        MemberListEntry *joinerMLE = new MemberListEntry((int) addr.addr[0], (short) addr.addr[4], heartbeat,
-                                                         par->globaltime);
-        //Add it to memberlist
-        memberNode->memberList.push_back(*joinerMLE);
-
-        //Log addition of member to memberlist
-        log->logNodeAdd(&memberNode->addr, &addr);
-
-        //Build return message
-        //Create a string from the memberlist
-        string list = to_string(1);
-        for (int i = 0; i < (int)memberNode->memberList.size(); i++) {
-            list = list + "," + to_string(memberNode->memberList[i].getid()) + ":" +
-                   to_string(memberNode->memberList[i].getport()) + ":" +
-                   to_string(memberNode->memberList[i].getheartbeat()) + ":" +
-                   to_string(memberNode->memberList[i].gettimestamp());
+        //Add node to memberlist and return memberlist in the JOINREP.
+        TRACEMSG(cout << "                Processing JOINREQ on node: ";
+                 printAddress(&memberNode->addr);
+                 cout << "JOINREQ msgsize: " << size << endl);
+        //Set incoming node variables from the single entry
+        reader.entry(0, mle);
+        Address addr(mle.getnodeid());
+        long heartbeat = mle.getheartbeat();
+
+        TRACEMSG(cout << "Joiner Address: ";
+                 printAddress(&addr));
+
+        //Build MLE from joiner data and add it to memberlist, logging it the first time it is seen.
+        //A joiner from another zone is handed over to the representative of its zone, which
+        //knows the zone's members first hand. If there is none yet, it becomes the representative.
+        MemberListEntry joiner(addr.getid(), addr.getport(), heartbeat, par->globaltime);
+        bool sameZone = inMyZone(addr.getid());
+        if (!sameZone) {
+            ZoneSummary &rep = zoneReps[par->zoneOf(addr.getid())];
+            if (rep.id != 0 && !(rep.id == addr.getid() && rep.port == addr.getport())
+                && par->globaltime - rep.timestamp <= TREMOVE) {
+                Address repAddr(rep.id, rep.port);
+                emulNet->ENsend(&memberNode->addr, &repAddr, data, size);
+                return 1;
+            }
+            zoneMerge(joiner, true);
+        }
+        else {
+            if (memberNode->memberList.find(addr.getid(), addr.getport()) == -1) {
+                log->logNodeAdd(&memberNode->addr, addr.nodeId());
+                //SWIM has no heartbeats to spread the news, pass it on with the probes
+                if (par->DETECTOR == SWIM_DETECTOR) {
+                    swimDisseminate(addr.getid(), addr.getport(), heartbeat);
+                }
+                queueTarget(addr.nodeId());
+            }
+            memberNode->memberList.insert(joiner);
         }
 
-        //Build the JoinRep message
-        //repMsg->msgType = JOINREP;
-        //char *repMsg = new char[list.size() + 1];
-        //copy(list.begin(), list.end(), repMsg);
-        //repMsg[list.size()] = '\0'; // don't forget the terminating 0
-        char *repMsg = strdup(list.c_str());
-        cout << "JoinReq outmsg MemberList String: " << string(repMsg) << endl;
-
-        //Build msgsize
-        int msgsize = (int)list.size()+1;
-
-        //Clear list until next time
-        list.clear();
+        //Build the JoinRep message from the memberlist, only myself for a joiner from another
+        //zone, and the representatives of the other zones
+        MessageWriter joinRep(sendBuff, sendBuffSize, JOINREP);
+        for (int i = 0; i < (int)memberNode->memberList.size(); i++) {
+            if ((sameZone || i == memberNode->myPos) && vouchFor(memberNode->memberList[i])
+                && !joinRep.append(memberNode->memberList[i])) {
+                break;
+            }
+        }
+        appendZoneSummaries(joinRep);
+        TRACEMSG(cout << "JoinReq outmsg MemberList entries: " << joinRep.getcount() << endl);
 
         //Send the JoinRep message
-        emulNet->ENsend(&memberNode->addr, &addr, repMsg, msgsize);
-
-        // don't forget to free the string after finished using it
-        //delete[]repMsg;
+        emulNet->ENsend(&memberNode->addr, &addr, sendBuff, joinRep.size());
 
         return 1;
     }
 
-    if (requestType == 1) {
+    if (reader.getType() == JOINREP) {
         //JOINREP
-        //Change char pointer into string then parse into memberlist
-        cout << "                Processing JOINREP on node: ";
-        printAddress(&memberNode->addr);
-        cout << "JOINREP msgsize: " << size << endl;
-        cout << "joinrep data: " << callBackData << endl;
-
-        //Build and populate the memberlist with dataVec that holds request type(at [0]) and memberlist
-        vector<string> tempMle;
-        for (int i = 0; i < (int)dataVec.size()-1; i++) {
-            split(dataVec[i+1],':',tempMle);
-            memberNode->memberList.push_back(MemberListEntry(stoi(tempMle[0]), (short)stoi(tempMle[1]), stol(tempMle[2]), stol(tempMle[3])));
-            tempMle.clear();
-        }
-        //Clear the dataVec vector since we don't need it anymore
-        dataVec.clear();
-
-        //Loop Build address and Log the node add
-        for (int i = 0; i < (int)memberNode->memberList.size()-1; i++){
-            Address addAddr(to_string(memberNode->memberList[i].getid()) + ":" +
-                            to_string(memberNode->memberList[i].getport()));
-            log->logNodeAdd(&memberNode->addr, &addAddr);
+        //Decode the entries straight into the memberlist
+        TRACEMSG(cout << "                Processing JOINREP on node: ";
+                 printAddress(&memberNode->addr);
+                 cout << "JOINREP msgsize: " << size << endl;
+                 cout << "joinrep entries: " << reader.getcount() << endl);
+
+        //Add every live member that is not myself and log the node add
+        for (int i = 0; i < reader.getcount(); i++) {
+            reader.entry(i, mle);
+            if (!inMyZone(mle.getid())) {
+                zoneMerge(mle, false);
+                continue;
+            }
+            if (mle.getheartbeat() == 0 || (mle.getid() == memberNode->addr.getid() && mle.getport() == memberNode->addr.getport())
+                || memberNode->memberList.find(mle.getid(), mle.getport()) != -1) {
+                continue;
+            }
+            mle.settimestamp(par->globaltime);
+            mle.setunconfirmed(par->DETECTOR == GOSSIP_DETECTOR);
+            memberNode->memberList.insert(mle);
+            log->logNodeAdd(&memberNode->addr, mle.getnodeid());
+            queueTarget(mle.getnodeid());
         }
 
         //Set myPos
-        memberNode->myPos = prev(memberNode->memberList.end());
+        memberNode->myPos = memberNode->memberList.insert(MemberListEntry(memberNode->addr.getid(), memberNode->addr.getport(),
+                                                                          memberNode->heartbeat, par->globaltime));
 
         //Successfully joined the group
         memberNode->inGroup = true;
@@ -334,59 +416,100 @@ bool MP1Node::recvCallBack(void *env, char *data, int size ) {
         return 1;
     }
 
-    if (requestType == 2) {
-        //GOSSIP
-        cout << "                Processing GOSSIP message on node: ";
-        printAddress(&memberNode->addr);
-        cout << "GOSSIP msgsize: " << size << endl;
-        cout << "GOSSIP Data: " << callBackData << endl;
-        //Build and populate the temp memberlist
-        vector<string> tempMle;
-        vector<MemberListEntry> tempMemList;
-        for (int i = 0; i < (int)dataVec.size()-1; i++) {
-            split(dataVec[i+1],':',tempMle);
-            tempMemList.push_back(MemberListEntry(stoi(tempMle[0]), (short)stoi(tempMle[1]), stol(tempMle[2]), stol(tempMle[3])));
-            tempMle.clear();
-        }
-        //Clear the dataVec vector since we don't need it anymore
-        dataVec.clear();
-
-        //See if there are any nodes in the tempMemList that the membernode doesn't have, then add them.
-        //TODO: this may need to change to a MemberListEntry assignment operator instead of a push_back
-        if (tempMemList.size() > memberNode->memberList.size()) {
-            int missingNodes = (int)(tempMemList.size()) - (int)memberNode->memberList.size();
-            cout<<"Missing Nodes size: "<<missingNodes<<endl;
-            for (int i=(int)(memberNode->memberList.size()); i < (int)(tempMemList.size()); i++){
-                memberNode->memberList.push_back(tempMemList[i]);
-                //Build address and Log the node add
-                Address addAddr(to_string(tempMemList[i].getid()) + ":" +
-                                 to_string(tempMemList[i].getport()));
-                log->logNodeAdd(&memberNode->addr, &addAddr);
-                cout<<"Node ";
-                printAddress(&addAddr);
-                cout<<" Added by ";
-                printAddress(&memberNode->addr);
-            }
+    if (reader.getType() == PING || reader.getType() == ACK || reader.getType() == PINGREQ) {
+        //Only once in the group: with latency jitter a probe can overtake the JOINREP,
+        //and before it there is no entry of my own to refute a suspicion with
+        if (memberNode->inGroup) {
+            swimReceive(reader);
         }
+        return 1;
+    }
 
-        //Now compare heartbeats of each node between memberlists, then update heartbeat and timestamp accordingly.
-        for (int i=0; i < (int)tempMemList.size(); i++){
-            if ((tempMemList[i].getheartbeat() > memberNode->memberList[i].getheartbeat()) && memberNode->memberList[i].getheartbeat() != 0){
-                memberNode->memberList[i].setheartbeat(tempMemList[i].getheartbeat());
-                memberNode->memberList[i].settimestamp(par->globaltime);
-            }
-        }
-        //Clear the tempMemList vector since we don't need it anymore
-        tempMemList.clear();
+    if (reader.getType() == GOSSIP) {
+        //GOSSIP
+        gossipHeard++;
+        TRACEMSG(cout << "                Processing GOSSIP message on node: ";
+                 printAddress(&memberNode->addr);
+                 cout << "GOSSIP msgsize: " << size << endl;
+                 cout << "GOSSIP entries: " << reader.getcount() << endl);
+
+        mergeGossip(reader, GOSSIP_SENDER + 1);
 
         return 1;
 
     }
 
+    if (reader.getType() == DIGEST || reader.getType() == DIGESTREP) {
+        //Anti-entropy exchange, answered from the memberlist once in the group
+        if (memberNode->inGroup && reader.getcount() >= DIGEST_HDR_ENTRIES) {
+            reader.entry(GOSSIP_SENDER, mle);
+            Address from(mle.getnodeid());
+            digestReceive(reader, &from);
+        }
+        return 1;
+    }
+
 return 0;
 
 }
 
+/**
+ * FUNCTION NAME: mergeGossip
+ *
+ * DESCRIPTION: Merge the entry of the sender and the entries from first on into the memberlist
+ */
+void MP1Node::mergeGossip(MessageReader &reader, int first) {
+    MemberListEntry mle;
+
+    //Merge each gossiped entry with the entry for the same id:port, whatever its position.
+    for (int i = 0; i < reader.getcount(); i++){
+        if (i != GOSSIP_SENDER && i < first) {
+            continue;
+        }
+        reader.entry(i, mle);
+        if (!inMyZone(mle.getid())) {
+            zoneMerge(mle, i == GOSSIP_SENDER);
+            continue;
+        }
+        int pos = memberNode->memberList.find(mle.getid(), mle.getport());
+
+        //A live node the membernode doesn't have, add it. Unless it is the sender, the
+        //news is second hand and may be old, so it is not passed on until a newer
+        //heartbeat comes in.
+        if (pos == -1) {
+            if (mle.getheartbeat() == 0) {
+                continue;
+            }
+            mle.settimestamp(par->globaltime);
+            mle.setunconfirmed(i != GOSSIP_SENDER);
+            memberNode->memberList.insert(mle);
+            //Log the node add
+            log->logNodeAdd(&memberNode->addr, mle.getnodeid());
+            queueTarget(mle.getnodeid());
+            TRACEEVENT(Address addAddr(mle.getnodeid());
+                       cout<<"Node ";
+                       printAddress(&addAddr);
+                       cout<<" Added by ";
+                       printAddress(&memberNode->addr));
+            continue;
+        }
+
+        //Otherwise compare heartbeats, then update heartbeat and timestamp accordingly.
+        //A newer heartbeat refutes any suspicion.
+        if ((mle.getheartbeat() > memberNode->memberList[pos].getheartbeat()) && memberNode->memberList[pos].getheartbeat() != 0){
+            //A heartbeat that came close to timing out, the gossip is too sparse
+            if (par->globaltime - memberNode->memberList[pos].gettimestamp() > par->GOSSIP_NEAR_MISS) {
+                nearMisses++;
+            }
+            memberNode->memberList[pos].setheartbeat(mle.getheartbeat());
+            memberNode->memberList[pos].settimestamp(par->globaltime);
+            memberNode->memberList[pos].setsuspect(false);
+            memberNode->memberList[pos].setunconfirmed(false);
+            memberNode->memberList.touch(pos);
+        }
+    }
+}
+
 
 /**
  * FUNCTION NAME: nodeLoopOps
@@ -396,106 +519,983 @@ return 0;
  * 				Propagate your membership list
  */
     void MP1Node::nodeLoopOps() {
-    cout << "                Starting nodeLoopOps on node: ";
-    printAddress(&memberNode->addr);
+    ProfileScope profile(PHASE_NODE_LOOP_OPS);
+    lastOps = par->globaltime;
+    if (par->DETECTOR == SWIM_DETECTOR) {
+        swimLoopOps();
+        return;
+    }
+    TRACEMSG(cout << "                Starting nodeLoopOps on node: ";
+             printAddress(&memberNode->addr));
     //Create a timestamp of the current time
     //long timestamp = (long) time(NULL);
 
-    //Find my location in the memberlist
-    int myLoc = 0;
-    for (int i=0; i < (int)memberNode->memberList.size(); i++){
-        if (memberNode->memberList[i].getid() == (int)memberNode->addr.addr[0]){
-            myLoc = i;
-        }
-    }
+    //My location in the memberlist
+    int myLoc = memberNode->myPos;
 
     //Update own heartbeat and timestamp in membernode and in memberlist
     //memberNode->heartbeat = memberNode->heartbeat +1;
     memberNode->memberList[myLoc].setheartbeat(++memberNode->heartbeat);
     memberNode->memberList[myLoc].settimestamp(par->globaltime);
+    memberNode->memberList.touch(myLoc);
+
+    //Moving average of the gossip heard per tick, to tell how much is lost
+    gossipRate += GOSSIP_RATE_WEIGHT * (gossipHeard - gossipRate);
+    gossipHeard = 0;
+
+    //Find the members not heard from in TFAIL and the tombstones past TOMBSTONE_TTL, in
+    //one sweep over the table or from the timers that ran out. Walk them backwards, so
+    //an entry moved into the place of an erased tombstone has already been handled.
+    int timeout = suspectTimeout();
+    MemberTable &members = memberNode->memberList;
+    bool timers = par->TIMEOUTS == WHEEL_TIMEOUTS;
+    int alive = members.liveCount();
+    int lowestLive = INT_MAX;
+    //First tick a member can time out or be forgotten at
+    int wake = INT_MAX;
+    if (timers) {
+        members.expire(par->globaltime, expired);
+    } else {
+        SweepResult res;
+        members.sweep(par->globaltime, TFAIL, par->TOMBSTONE_TTL, false, expired, res);
+        lowestLive = min(memberNode->addr.getid(), (int)res.lowestFresh);
+        if (res.oldestWatched != INT32_MAX) {
+            wake = min(wake, (int)res.oldestWatched + TFAIL + timeout + 1);
+        }
+        if (res.oldestDead != INT32_MAX) {
+            wake = min(wake, (int)res.oldestDead + par->TOMBSTONE_TTL + 1);
+        }
+    }
+    for(int k = (int)expired.size() - 1; k >= 0; k--){
+        int i = expired[k];
+        MemberRef mle = members[i];
+        if (mle.getheartbeat() == 0) {
+            //Forget the tombstone once no stale gossip can bring the member back
+            eraseMember(i);
+            myLoc = memberNode->myPos;
+            continue;
+        }
+        long stale = par->globaltime - mle.gettimestamp();
+        //No news for TFAIL, suspect it. A newer heartbeat clears it again.
+        mle.setsuspect(true);
+        if (stale > TFAIL + timeout) {
+            //Flag node as failed, it stays as a tombstone until TOMBSTONE_TTL runs out.
+            mle.setheartbeat(0);
+            mle.setsuspect(false);
+            mle.settimestamp(par->globaltime);
+            //Build address and Log the removal of the member
+            Address remAddr(mle.getnodeid());
+            TRACEEVENT(cout << "Node ";
+                       printAddress(&remAddr);
+                       cout << " Failed by ";
+                       printAddress(&memberNode->addr));
+            log->logNodeRemove(&memberNode->addr, remAddr.nodeId());
+            Profiler::get().nodeRemoved(remAddr.getid(), par->globaltime);
+            wake = min(wake, par->globaltime + par->TOMBSTONE_TTL + 1);
+            continue;
+        }
+        wake = min(wake, (int)mle.gettimestamp() + TFAIL + timeout + 1);
+    }
+    //With timers, no member times out before the earliest one still set
+    if (timers) {
+        wake = members.nextExpiry();
+        if (!zoneReps.empty()) {
+            lowestLive = lowestLiveId();
+        }
+    }
+
+    if (memberNode->pingCounter >= nextGossip) {
+        adaptGossipInterval();
+        nextGossip = memberNode->pingCounter + gossipInterval;
+
+        //Encode the memberlist into a GOSSIP message, as much of it as fits.
+        //Delta gossip is built per target instead.
+        int msgsize = 0;
+        if (par->GOSSIP_MODE == FULL_GOSSIP) {
+            MessageWriter gossip(sendBuff, sendBuffSize, GOSSIP);
+            gossip.append(memberNode->memberList[myLoc]);
+            for (int i = 0; i < (int) memberNode->memberList.size(); i++) {
+                if (i != myLoc && vouchFor(memberNode->memberList[i]) && !gossip.append(memberNode->memberList[i])) {
+                    break;
+                }
+            }
+            appendZoneSummaries(gossip);
+            msgsize = gossip.size();
+            TRACEMSG(cout << "NodeLoops MemberList entries: " << gossip.getcount() << endl);
+        }
+
+        //Pick the members to gossip to among the live ones other than self. Members not
+        //heard from in TREMOVE/2 are most likely down, gossiping to them wastes the fanout.
+        MemberTable &list = memberNode->memberList;
+        int now = par->globaltime;
+        auto fresh = [&list, myLoc, now](int pos) {
+            return pos != myLoc && now - list[pos].gettimestamp() <= TREMOVE / 2;
+        };
+        int fanout = gossipFanout(alive);
+        gossipLastFanout = fanout;
+        pickTargets(fanout, fresh, picks);
 
-    //Loop through memberlist to check for timed-out members
-    for(int i=0; i < (int)memberNode->memberList.size(); i++){
-        if((par->globaltime - memberNode->memberList[i].gettimestamp()) > TREMOVE){
-            if (memberNode->memberList[i].getheartbeat() != 0) {
-                //Flag node as failed.
-                memberNode->memberList[i].setheartbeat(0);
-                //Build address and Log the removal of the member
-                Address remAddr(to_string(memberNode->memberList[i].getid()) + ":" +
-                                to_string(memberNode->memberList[i].getport()));
-                cout << "Node ";
-                printAddress(&remAddr);
-                cout << " Failed by ";
-                printAddress(&memberNode->addr);
-                log->logNodeRemove(&memberNode->addr, &remAddr);
+        //Loop send message for selected members
+        sendTargets.clear();
+        for (int i = 0; i < (int)picks.size(); i++) {
+            Address sendAddr(list[picks[i]].getnodeid());
+
+            //Send the gossip message.
+            TRACEMSG(cout << i + 1 << "th address to be gossiped to: ";
+                     printAddress(&sendAddr));
+            if (par->GOSSIP_MODE == DELTA_GOSSIP) {
+                msgsize = buildDeltaGossip(list[picks[i]]);
+                emulNet->ENsend(&memberNode->addr, &sendAddr, sendBuff, msgsize);
+            } else {
+                sendTargets.push_back(sendAddr);
             }
         }
+        //Full gossip is the same message for every target, sent as one shared payload
+        if (!sendTargets.empty()) {
+            emulNet->ENsendv(&memberNode->addr, &sendTargets[0], (int)sendTargets.size(), sendBuff, msgsize);
+        }
+
+        //The live member with the lowest id represents the zone to the other zones
+        if (!zoneReps.empty() && lowestLive == memberNode->addr.getid()) {
+            sendZoneGossip();
+        }
+
+        //Every ANTI_ENTROPY rounds, reconcile the memberlist with one random member
+        if (par->ANTI_ENTROPY > 0 && ++antiEntropyRounds >= par->ANTI_ENTROPY && list.sample(1, fresh, rng, picks) > 0) {
+            antiEntropyRounds = 0;
+            Address peerAddr(list[picks[0]].getnodeid());
+            sendDigest(&peerAddr);
+        }
     }
 
+    //Increment the ping counter
+    memberNode->pingCounter = memberNode->pingCounter +1;
+
+    //Run again at the next timeout or gossip round, whichever comes first
+    wake = min(wake, par->globaltime + 1 + max(0, nextGossip - (int)memberNode->pingCounter));
+    wakeTick = max(wake, par->globaltime + 1);
 
+    return;
+    }
 
-    if (memberNode->pingCounter % 5 == 0) {
+/**
+ * FUNCTION NAME: gossipLoss
+ *
+ * DESCRIPTION: Estimated share of the gossip lost on the way. Every member runs the same
+ * 				policy, so each should hear about as many messages per tick as it sends;
+ * 				the shortfall is what was lost. Capped at GOSSIP_MAX_LOSS.
+ */
+    double MP1Node::gossipLoss() {
+    if (gossipLastFanout == 0) {
+        return 0;
+    }
+    double loss = 1.0 - gossipRate * gossipInterval / gossipLastFanout;
+    return min(GOSSIP_MAX_LOSS, max(0.0, loss));
+    }
 
-        //Create a string to hold memlist, with first value of 2(GOSSIP msgtype)
-        string gosMemList = to_string(2);
+/**
+ * FUNCTION NAME: gossipFanout
+ *
+ * DESCRIPTION: Members to gossip to this round. Adaptive fanout is (ln(alive) + 1) / (1 - loss),
+ * 				enough for a rumor to reach the whole group when that share of it is lost.
+ */
+    int MP1Node::gossipFanout(int alive) {
+    if (par->GOSSIP_FANOUT > 0) {
+        return par->GOSSIP_FANOUT;
+    }
+    double fanout = (std::log((double)alive) + 1) / (1.0 - gossipLoss());
+    return max(2, (int)ceil(fanout));
+    }
 
-        //Build a memberlist into string
-        for (int i = 0; i < (int) memberNode->memberList.size(); i++) {
-            gosMemList = gosMemList + "," + to_string(memberNode->memberList[i].getid()) + ":" +
-                         to_string(memberNode->memberList[i].getport()) + ":" +
-                         to_string(memberNode->memberList[i].getheartbeat()) + ":" +
-                         to_string(memberNode->memberList[i].gettimestamp());
+/**
+ * FUNCTION NAME: adaptGossipInterval
+ *
+ * DESCRIPTION: Called once per round. Any heartbeat merged since the last round that came
+ * 				more than GOSSIP_NEAR_MISS ticks after the one before shows the gossip is
+ * 				too sparse for the loss and group at hand: shorten the interval. After
+ * 				GOSSIP_CALM_ROUNDS rounds without one, try a longer interval.
+ */
+    void MP1Node::adaptGossipInterval() {
+    if (par->GOSSIP_INTERVAL > 0) {
+        return;
+    }
+    if (nearMisses > 0) {
+        gossipInterval = max(1, gossipInterval - 1);
+        calmRounds = 0;
+    }
+    else if (++calmRounds >= GOSSIP_CALM_ROUNDS) {
+        gossipInterval = min(par->GOSSIP_INTERVAL_MAX, gossipInterval + 1);
+        calmRounds = 0;
+    }
+    nearMisses = 0;
+    }
+
+/**
+ * FUNCTION NAME: pickTargets
+ *
+ * DESCRIPTION: Put the positions of up to k live members accept(position) is true for
+ * 				into out. TARGETS random samples them afresh each time. TARGETS roundrobin
+ * 				takes them in turn from a shuffled order of the members, shuffled again
+ * 				once it runs out, so each member is picked within members / k calls.
+ * 				Members that join are put in the rest of the current order.
+ * 				Returns the number picked.
+ */
+template<class Accept> int MP1Node::pickTargets(int k, Accept accept, vector<int> &out) {
+    MemberTable &list = memberNode->memberList;
+    if (par->TARGETS == RANDOM_TARGETS) {
+        return list.sample(k, accept, rng, out);
+    }
+    out.clear();
+    //Stamp the positions picked, a member may come up twice across a reshuffle
+    //or after it left and joined again
+    if ((int)pickStamp.size() < list.size()) {
+        pickStamp.resize(list.size(), 0);
+    }
+    pickRound++;
+    //Look at most at the rest of this order and a whole new one
+    int budget = (int)targetOrder.size() - targetNext + list.liveCount();
+    for (int looked = 0; looked < budget && (int)out.size() < k; looked++) {
+        if (targetNext >= (int)targetOrder.size()) {
+            targetOrder.clear();
+            for (int i = 0; i < list.liveCount(); i++) {
+                targetOrder.push_back(list[list.liveEntry(i)].getnodeid());
+            }
+            shuffle(targetOrder.begin(), targetOrder.end(), rng);
+            targetNext = 0;
         }
-        cout << "NodeLoops MemberList String: " << gosMemList << endl;
+        int pos = list.find(targetOrder[targetNext++]);
+        if (pos == -1 || list[pos].getheartbeat() == 0 || !accept(pos) || pickStamp[pos] == pickRound) {
+            continue;
+        }
+        pickStamp[pos] = pickRound;
+        out.push_back(pos);
+    }
+    return (int)out.size();
+}
 
-        //Build char pointer from gosMemList to use in ENsend
-        char *gosMsg = new char[gosMemList.size() + 1];
-        copy(gosMemList.begin(), gosMemList.end(), gosMsg);
-        gosMsg[gosMemList.size()] = '\0'; // don't forget the terminating 0
-        //char *gosMsg = strdup(gosMemList.c_str());
+/**
+ * FUNCTION NAME: queueTarget
+ *
+ * DESCRIPTION: TARGETS roundrobin: put a member that was just added to the memberlist
+ * 				at a random place in the rest of the current order, so it is gossiped
+ * 				to in this order rather than after the next shuffle
+ */
+void MP1Node::queueTarget(NodeId node) {
+    if (par->TARGETS != ROUND_ROBIN_TARGETS) {
+        return;
+    }
+    targetOrder.push_back(node);
+    int last = (int)targetOrder.size() - 1;
+    swap(targetOrder[last], targetOrder[targetNext + rng() % (last - targetNext + 1)]);
+}
 
-        //Build msgsize
-        int msgsize = (int)gosMemList.size()+1;
+/**
+ * FUNCTION NAME: buildDeltaGossip
+ *
+ * DESCRIPTION: Encode a GOSSIP message for peer holding only the entries that changed
+ * 				since the last gossip sent to it, plus a few random unchanged entries
+ * 				to repair anything lost to message drops.
+ * 				Returns the message size.
+ */
+    int MP1Node::buildDeltaGossip(MemberRef peer) {
+        MemberTable &list = memberNode->memberList;
+        long &sent = peerVersions[peer.getnodeid()];
+        long since = sent;
+        int capacity = max(1, MessageWriter::maxEntries(sendBuffSize) - par->GOSSIP_RANDOM - 1);
+        if (par->GOSSIP_MAX_ENTRIES > 0 && par->GOSSIP_MAX_ENTRIES < capacity) {
+            capacity = par->GOSSIP_MAX_ENTRIES;
+        }
+
+        deltaEntries.clear();
+        for (int i = 0; i < list.size(); i++) {
+            if (list.getversion(i) > since && i != memberNode->myPos && vouchFor(list[i])) {
+                deltaEntries.push_back(i);
+            }
+        }
 
-        //Clear gosMemList until next time
-        //delete gosMemList;
+        //Too many changes for one message: send the most recent ones. Older changes
+        //of live members are superseded by their next heartbeat anyway.
+        if ((int)deltaEntries.size() > capacity) {
+            nth_element(deltaEntries.begin(), deltaEntries.begin() + capacity - 1, deltaEntries.end(),
+                        [&list](int a, int b) { return list.getversion(a) > list.getversion(b); });
+            deltaEntries.resize(capacity);
+        }
+        sent = list.getclock();
 
-        //Find non-failed nodes to gossip to and place node location into vector. Also exclude self from possible gossip targets.
-        vector<int> nonFail;
-        for (int i = 0; i < (int) memberNode->memberList.size(); i++) {
-            if ((memberNode->memberList[i].getheartbeat() > 0) && (i != myLoc)) {
-                nonFail.push_back(i);
+        MessageWriter gossip(sendBuff, sendBuffSize, GOSSIP);
+        gossip.append(list[memberNode->myPos]);
+        for (int i = 0; i < (int)deltaEntries.size(); i++) {
+            gossip.append(list[deltaEntries[i]]);
+        }
+        for (int i = 0; i < par->GOSSIP_RANDOM && list.size() > 0; i++) {
+            int pos = rng() % list.size();
+            if (list.getversion(pos) <= since && vouchFor(list[pos]) && !gossip.append(list[pos])) {
+                break;
             }
         }
+        appendZoneSummaries(gossip);
+        TRACEMSG(cout << "Delta gossip entries: " << gossip.getcount() << endl);
 
-        //Randomize the non-failed nodes
-        random_shuffle(nonFail.begin(), nonFail.end());
+        return gossip.size();
+    }
 
-        //Loop send message for selected members
-        for (int i = 0; i < 4; i++) {
-            if (i < (int)nonFail.size()) {
-                //Build an address for each node in nonFail.
-                Address sendAddr(to_string(memberNode->memberList[nonFail[i]].getid()) + ":" +
-                                 to_string(memberNode->memberList[nonFail[i]].getport()));
-
-                //Send the gossip message.
-                cout << i + 1 << "th address to be gossiped to: ";
-                printAddress(&sendAddr);
-                emulNet->ENsend(&memberNode->addr, &sendAddr, gosMsg, msgsize);
+/**
+ * FUNCTION NAME: digestBuckets
+ *
+ * DESCRIPTION: Buckets of the digest this node starts an exchange with: a power of two
+ * 				with about DIGEST_BUCKET_MEMBERS members each, using at most half of a
+ * 				message so the reply still has room for entries.
+ */
+    int MP1Node::digestBuckets() {
+        int room = (MessageWriter::maxEntries(sendBuffSize) - DIGEST_HDR_ENTRIES) / 2;
+        int buckets = 1;
+        while (buckets * 2 <= room && buckets * DIGEST_BUCKET_MEMBERS < memberNode->memberList.size()) {
+            buckets *= 2;
+        }
+        return buckets;
+    }
+
+/**
+ * FUNCTION NAME: buildDigest
+ *
+ * DESCRIPTION: Count and XOR the hashes of the live members in each bucket. Heartbeats
+ * 				move on every tick, so they are left out: the digest tells which members
+ * 				a node knows about, the entries sent for the buckets that differ bring
+ * 				their heartbeats along.
+ */
+    void MP1Node::buildDigest(int buckets) {
+    MemberTable &list = memberNode->memberList;
+    digestCount.assign(buckets, 0);
+    digestHash.assign(buckets, 0);
+    for (int i = 0; i < list.size(); i++) {
+        if (list[i].getheartbeat() != 0) {
+            uint64_t h = Random::mix(list[i].getnodeid().value());
+            int bucket = (int)(h >> 32) & (buckets - 1);
+            digestCount[bucket]++;
+            digestHash[bucket] ^= (uint32_t)h;
+        }
+    }
+    }
+
+/**
+ * FUNCTION NAME: appendDiffering
+ *
+ * DESCRIPTION: Compare the digest last built against the buckets of remote and append
+ * 				the members this node vouches for from every bucket that differs, as
+ * 				many as fit. The walk starts at a random member, so buckets too large
+ * 				for one message go out over several exchanges.
+ * 				Returns the number of buckets that differ.
+ */
+    int MP1Node::appendDiffering(MessageWriter &msg, MessageReader &remote, int buckets) {
+    MemberTable &list = memberNode->memberList;
+    MemberListEntry mle;
+    int differing = 0;
+    for (int k = 0; k < buckets; k++) {
+        remote.entry(DIGEST_HDR_ENTRIES + k, mle);
+        if (mle.getid() == digestCount[k] && (uint32_t)mle.getheartbeat() == digestHash[k]) {
+            //Mark the bucket as in sync
+            digestCount[k] = -1;
+        }
+        else {
+            differing++;
+        }
+    }
+    if (differing == 0) {
+        return 0;
+    }
+
+    int start = rng() % list.size();
+    for (int j = 0; j < list.size(); j++) {
+        int pos = (start + j) % list.size();
+        if (pos == memberNode->myPos || !vouchFor(list[pos])) {
+            continue;
+        }
+        int bucket = (int)(Random::mix(list[pos].getnodeid().value()) >> 32) & (buckets - 1);
+        if (digestCount[bucket] != -1 && !msg.append(list[pos])) {
+            break;
+        }
+    }
+    return differing;
+    }
+
+/**
+ * FUNCTION NAME: sendDigest
+ *
+ * DESCRIPTION: Start a push-pull anti-entropy exchange with to by sending the digest
+ * 				of the memberlist
+ */
+    void MP1Node::sendDigest(Address *to) {
+    int buckets = digestBuckets();
+    buildDigest(buckets);
+    MessageWriter msg(sendBuff, sendBuffSize, DIGEST);
+    msg.append(memberNode->memberList[memberNode->myPos]);
+    msg.append(buckets, 0, 0);
+    for (int k = 0; k < buckets; k++) {
+        msg.append(digestCount[k], 0, (int32_t)digestHash[k]);
+    }
+    emulNet->ENsend(&memberNode->addr, to, sendBuff, msg.size());
+    }
+
+/**
+ * FUNCTION NAME: digestReceive
+ *
+ * DESCRIPTION: Handle both legs of the exchange that carry a digest. A DIGEST is answered
+ * 				with this node's digest and its side of the buckets that differ. A
+ * 				DIGESTREP is merged, then the buckets that still differ are pushed back
+ * 				in a last DIGESTREP without buckets, which only gets merged.
+ */
+    void MP1Node::digestReceive(MessageReader &reader, Address *from) {
+    MemberListEntry mle;
+    reader.entry(DIGEST_INFO, mle);
+    int buckets = mle.getid();
+    if (buckets < 0 || (buckets & (buckets - 1)) != 0 || DIGEST_HDR_ENTRIES + buckets > reader.getcount()
+        || (reader.getType() == DIGEST && buckets == 0)) {
+        return;
+    }
+    mergeGossip(reader, DIGEST_HDR_ENTRIES + buckets);
+    if (buckets == 0) {
+        return;
+    }
+
+    buildDigest(buckets);
+    MessageWriter msg(sendBuff, sendBuffSize, DIGESTREP);
+    msg.append(memberNode->memberList[memberNode->myPos]);
+    if (reader.getType() == DIGEST) {
+        msg.append(buckets, 0, 0);
+        for (int k = 0; k < buckets; k++) {
+            msg.append(digestCount[k], 0, (int32_t)digestHash[k]);
+        }
+    }
+    else {
+        msg.append(0, 0, 0);
+    }
+    int header = msg.getcount();
+    int differing = appendDiffering(msg, reader, buckets);
+    //Nothing differs, or nothing is left to push back: the exchange is over
+    if (differing == 0 || (reader.getType() == DIGESTREP && msg.getcount() == header)) {
+        return;
+    }
+    emulNet->ENsend(&memberNode->addr, from, sendBuff, msg.size());
+    }
+
+/**
+ * FUNCTION NAME: inMyZone
+ *
+ * DESCRIPTION: Whether the node with this id is tracked in the memberlist. Always true
+ * 				unless the hierarchical mode is on.
+ */
+    bool MP1Node::inMyZone(int id) {
+    return par->zoneOf(id) == par->zoneOf(memberNode->addr.getid());
+    }
+
+/**
+ * FUNCTION NAME: zoneMerge
+ *
+ * DESCRIPTION: Merge a member of another zone into the summary of its zone. A newer
+ * 				heartbeat of the current representative refreshes it; any other member
+ * 				takes its place once it has not been heard from for TREMOVE. Second hand
+ * 				news of a new representative is not passed on until its heartbeat moves.
+ */
+    void MP1Node::zoneMerge(MemberListEntry &mle, bool firstHand) {
+    if (mle.getheartbeat() <= 0) {
+        return;
+    }
+    ZoneSummary &rep = zoneReps[par->zoneOf(mle.getid())];
+    if (rep.id == mle.getid() && rep.port == mle.getport()) {
+        if (mle.getheartbeat() > rep.heartbeat) {
+            rep.heartbeat = mle.getheartbeat();
+            rep.timestamp = par->globaltime;
+            rep.unconfirmed = false;
+        }
+        return;
+    }
+    if (rep.id == 0 || par->globaltime - rep.timestamp > TREMOVE) {
+        rep.id = mle.getid();
+        rep.port = mle.getport();
+        rep.heartbeat = mle.getheartbeat();
+        rep.timestamp = par->globaltime;
+        rep.unconfirmed = !firstHand;
+    }
+    }
+
+/**
+ * FUNCTION NAME: appendZoneSummaries
+ *
+ * DESCRIPTION: Append the representatives of the other zones heard from within TREMOVE,
+ * 				as many as fit, starting at a random zone
+ */
+    void MP1Node::appendZoneSummaries(MessageWriter &msg) {
+    int zones = zoneReps.size();
+    if (zones == 0) {
+        return;
+    }
+    int myZone = par->zoneOf(memberNode->addr.getid());
+    int start = rng() % zones;
+    for (int k = 0; k < zones; k++) {
+        ZoneSummary &rep = zoneReps[(start + k) % zones];
+        //Heard from lately, and first hand or since its heartbeat moved, as vouchFor
+        if ((start + k) % zones == myZone || rep.id == 0 || par->globaltime - rep.timestamp > TREMOVE
+            || (rep.unconfirmed && par->globaltime - rep.timestamp > TFAIL)) {
+            continue;
+        }
+        if (!msg.append(rep.id, rep.port, rep.heartbeat)) {
+            break;
+        }
+    }
+    }
+
+/**
+ * FUNCTION NAME: sendZoneGossip
+ *
+ * DESCRIPTION: Gossip from the representative of this zone to the representatives of
+ * 				other zones: this node, standing for its zone, and the zone summaries.
+ * 				Representatives not heard from lately are gossiped to as well, after
+ * 				a mass failure they may be all this node knows of the other zones.
+ */
+    void MP1Node::sendZoneGossip() {
+        zonePicks.clear();
+        for (int z = 0; z < (int)zoneReps.size(); z++) {
+            if (zoneReps[z].id != 0 && z != par->zoneOf(memberNode->addr.getid())) {
+                zonePicks.push_back(z);
             }
         }
+        if (zonePicks.empty()) {
+            return;
+        }
+
+        MessageWriter gossip(sendBuff, sendBuffSize, GOSSIP);
+        gossip.append(memberNode->memberList[memberNode->myPos]);
+        appendZoneSummaries(gossip);
 
-        //delete msgsize;
-        //Clear nonFail
-        nonFail.clear();
-        // don't forget to free the string after finished using it
-        delete[]gosMsg;
+        int fanout = min((int)zonePicks.size(), gossipFanout(zonePicks.size() + 1));
+        sendTargets.clear();
+        for (int i = 0; i < fanout; i++) {
+            swap(zonePicks[i], zonePicks[i + rng() % (zonePicks.size() - i)]);
+            sendTargets.push_back(Address(zoneReps[zonePicks[i]].id, zoneReps[zonePicks[i]].port));
+        }
+        emulNet->ENsendv(&memberNode->addr, &sendTargets[0], fanout, sendBuff, gossip.size());
     }
 
-    //Increment the ping counter
-    memberNode->pingCounter = memberNode->pingCounter +1;
+/**
+ * FUNCTION NAME: zonesKnown
+ *
+ * DESCRIPTION: Other zones with a representative heard from within TREMOVE
+ */
+    int MP1Node::zonesKnown() {
+    int known = 0;
+    for (int z = 0; z < (int)zoneReps.size(); z++) {
+        if (zoneReps[z].id != 0 && z != par->zoneOf(memberNode->addr.getid())
+            && par->globaltime - zoneReps[z].timestamp <= TREMOVE) {
+            known++;
+        }
+    }
+    return known;
+    }
 
-    return;
+/**
+ * FUNCTION NAME: zoneMemoryBytes
+ *
+ * DESCRIPTION: Memory held by the zone summaries
+ */
+    long MP1Node::zoneMemoryBytes() {
+    return (long)zoneReps.capacity() * sizeof(ZoneSummary);
+    }
+
+/**
+ * FUNCTION NAME: swimLoopOps
+ *
+ * DESCRIPTION: SWIM failure detector. Probe one random member per protocol period.
+ * 				If it does not ack within SWIM_ACK_TIMEOUT, ask SWIM_K other members
+ * 				to probe it, and declare it failed if no ack came back by the end of
+ * 				the period. Membership updates travel piggybacked on the probes.
+ */
+    void MP1Node::swimLoopOps() {
+    MemberTable &list = memberNode->memberList;
+    int now = par->globaltime;
+
+    //Outcome of the probe in progress
+    if (probeTarget != -1 && !probeAcked) {
+        if (!probeIndirect && now - probeStart >= SWIM_ACK_TIMEOUT) {
+            int myPos = memberNode->myPos;
+            int target = probeTarget;
+            auto canHelp = [&list, myPos, target](int pos) {
+                return !list[pos].getsuspect() && pos != myPos && pos != target;
+            };
+            list.sample(par->SWIM_K, canHelp, rng, picks);
+            for (int i = 0; i < (int)picks.size(); i++) {
+                Address helper(list[picks[i]].getnodeid());
+                swimSend(PINGREQ, &helper, list[probeTarget].getid(), list[probeTarget].getport(), probeSeq);
+            }
+            probeIndirect = true;
+        }
+        else if (probeIndirect && now - probeStart >= SWIM_PERIOD && list[probeTarget].getheartbeat() != 0
+                 && !list[probeTarget].getsuspect()) {
+            swimSuspect(probeTarget);
+        }
+    }
+
+    //Remove members suspected for too long, and forget old tombstones. Walk backwards,
+    //so an entry moved into the place of an erased one has already been checked.
+    int timeout = suspectTimeout();
+    SweepResult res;
+    list.sweep(now, timeout, par->TOMBSTONE_TTL, true, expired, res);
+    bool failedNow = false;
+    for (int k = (int)expired.size() - 1; k >= 0; k--) {
+        int i = expired[k];
+        if (list[i].getheartbeat() != 0) {
+            swimMarkFailed(i);
+            failedNow = true;
+        }
+        else {
+            if (probeTarget == i) {
+                probeTarget = -1;
+            }
+            int moved = eraseMember(i);
+            if (probeTarget == moved) {
+                probeTarget = i;
+            }
+        }
+    }
+
+    //Start the probe of the next period
+    if (now - probeStart >= SWIM_PERIOD) {
+        probeTarget = -1;
+        int myPos = memberNode->myPos;
+        auto other = [myPos](int pos) {
+            return pos != myPos;
+        };
+        if (pickTargets(1, other, picks) > 0) {
+            probeTarget = picks[0];
+            probeSeq++;
+            probeStart = now;
+            probeAcked = false;
+            probeIndirect = false;
+            Address target(list[probeTarget].getnodeid());
+            swimSend(PING, &target, memberNode->addr.getid(), memberNode->addr.getport(), probeSeq);
+        }
+    }
+
+    //Run again when the probe moves on, or a member times out or is forgotten.
+    //With no one to probe, the probe is retried on every tick.
+    int wake = probeStart + SWIM_PERIOD;
+    if (probeTarget != -1 && !probeAcked && !probeIndirect) {
+        wake = min(wake, probeStart + SWIM_ACK_TIMEOUT);
+    }
+    //The sweep saw every suspect and tombstone still around, only the timeout may
+    //have changed with the erasures, and the members failed now are new tombstones
+    timeout = suspectTimeout();
+    if (res.oldestWatched != INT32_MAX) {
+        wake = min(wake, (int)res.oldestWatched + timeout + 1);
+    }
+    if (res.oldestDead != INT32_MAX) {
+        wake = min(wake, (int)res.oldestDead + par->TOMBSTONE_TTL + 1);
+    }
+    if (failedNow) {
+        wake = min(wake, now + par->TOMBSTONE_TTL + 1);
+    }
+    wakeTick = max(wake, now + 1);
+    }
+
+/**
+ * FUNCTION NAME: swimReceive
+ *
+ * DESCRIPTION: Handle a SWIM PING, ACK or PINGREQ and the updates piggybacked on it
+ */
+    void MP1Node::swimReceive(MessageReader &reader) {
+    MemberTable &list = memberNode->memberList;
+    MemberListEntry sender, origin, mle;
+
+    if (reader.getcount() < SWIM_HDR_ENTRIES) {
+        return;
+    }
+    reader.entry(SWIM_SENDER, sender);
+    reader.entry(SWIM_ORIGIN, origin);
+    long seq = origin.getheartbeat();
+
+    //A sender never heard of is up. Suspicion of a known one is only lifted by a
+    //higher incarnation, as a stale message may still be on its way.
+    if (list.find(sender.getid(), sender.getport()) == -1) {
+        MemberListEntry up(sender.getid(), sender.getport(), 1, par->globaltime);
+        swimAddMember(up);
+    }
+
+    for (int i = SWIM_HDR_ENTRIES; i < reader.getcount(); i++) {
+        reader.entry(i, mle);
+        swimUpdate(mle);
+    }
+
+    if (reader.getType() == PING) {
+        //Ack to whoever sent the ping, which relays it if it probed for someone else
+        Address to(sender.getnodeid());
+        swimSend(ACK, &to, origin.getid(), origin.getport(), seq);
+    }
+    else if (reader.getType() == ACK) {
+        if (origin.getid() == memberNode->addr.getid() && origin.getport() == memberNode->addr.getport()) {
+            if (seq == probeSeq) {
+                probeAcked = true;
+            }
+        }
+        else {
+            Address to(origin.getnodeid());
+            swimSend(ACK, &to, origin.getid(), origin.getport(), seq);
+        }
+    }
+    else if (reader.getType() == PINGREQ) {
+        //Probe the requested member on behalf of the sender
+        Address target(origin.getnodeid());
+        swimSend(PING, &target, sender.getid(), sender.getport(), sender.getheartbeat());
+    }
+    }
+
+/**
+ * FUNCTION NAME: swimSend
+ *
+ * DESCRIPTION: Send a SWIM message with the updates that were sent the fewest times piggybacked
+ */
+    void MP1Node::swimSend(enum MsgTypes type, Address *to, int originId, short originPort, long seq) {
+    MessageWriter msg(sendBuff, sendBuffSize, type);
+    msg.append(memberNode->addr.getid(), memberNode->addr.getport(), seq);
+    msg.append(originId, originPort, seq);
+
+    swimPicked.clear();
+    while (swimTop > 0 && (int)swimPicked.size() < SWIM_PIGGYBACK) {
+        vector<int> &bucket = swimBuckets[swimTop];
+        if (bucket.empty()) {
+            swimTop--;
+            continue;
+        }
+        int slot = bucket.back();
+        if (slot != -1) {
+            SwimUpdate &update = swimUpdates[slot];
+            if (!msg.append(update.id, update.port, update.heartbeat)) {
+                break;
+            }
+            swimPicked.push_back(slot);
+        }
+        bucket.pop_back();
+    }
+    //Each update sent moves down a bucket, ahead of the updates already there and
+    //in the order they were picked
+    for (int i = (int)swimPicked.size() - 1; i >= 0; i--) {
+        int slot = swimPicked[i];
+        SwimUpdate &update = swimUpdates[slot];
+        if (--update.sendsLeft == 0) {
+            swimSlot.erase(NodeId(update.id, update.port));
+            swimFree.push_back(slot);
+            continue;
+        }
+        update.bucketPos = (int)swimBuckets[update.sendsLeft].size();
+        swimBuckets[update.sendsLeft].push_back(slot);
+        swimTop = max(swimTop, update.sendsLeft);
+    }
+
+    emulNet->ENsend(&memberNode->addr, to, sendBuff, msg.size());
+    }
+
+/**
+ * FUNCTION NAME: swimDisseminate
+ *
+ * DESCRIPTION: Queue an update for piggybacking, replacing any older update about the same member.
+ * 				It is sent SWIM_LAMBDA * log2(group size) times, ahead of older updates
+ * 				with as many sends left.
+ */
+    void MP1Node::swimDisseminate(int id, short port, long heartbeat) {
+    int sends = max(1, SWIM_LAMBDA * (int)ceil(log2(memberNode->memberList.size() + 1)));
+    NodeId node(id, port);
+    int slot;
+    auto found = swimSlot.find(node);
+    if (found != swimSlot.end()) {
+        slot = found->second;
+        swimBuckets[swimUpdates[slot].sendsLeft][swimUpdates[slot].bucketPos] = -1;
+    }
+    else if (!swimFree.empty()) {
+        slot = swimFree.back();
+        swimFree.pop_back();
+        swimSlot[node] = slot;
+    }
+    else {
+        slot = (int)swimUpdates.size();
+        swimUpdates.push_back(SwimUpdate());
+        swimSlot[node] = slot;
+    }
+    if ((int)swimBuckets.size() <= sends) {
+        swimBuckets.resize(sends + 1);
+    }
+    //Newest first, so a suspicion or its refutation is not held up behind a backlog of joins
+    SwimUpdate update = { id, port, heartbeat, sends, (int)swimBuckets[sends].size() };
+    swimUpdates[slot] = update;
+    swimBuckets[sends].push_back(slot);
+    swimTop = max(swimTop, sends);
+    }
+
+/**
+ * FUNCTION NAME: swimUpdate
+ *
+ * DESCRIPTION: Apply a piggybacked update. The heartbeat carries the state of the member:
+ * 				the incarnation if it is alive, minus the incarnation if it is suspected,
+ * 				0 if it failed. An update about a member wins over what is known if its
+ * 				incarnation is higher, or if it is equal and the update is a suspicion.
+ */
+    void MP1Node::swimUpdate(MemberListEntry &mle) {
+    MemberTable &list = memberNode->memberList;
+    long hb = mle.getheartbeat();
+    long inc = hb < 0 ? -hb : hb;
+
+    if (mle.getid() == memberNode->addr.getid() && mle.getport() == memberNode->addr.getport()) {
+        //Suspected myself: refute it with a higher incarnation
+        if (hb < 0 && inc >= memberNode->heartbeat) {
+            memberNode->heartbeat = inc + 1;
+            list[memberNode->myPos].setheartbeat(memberNode->heartbeat);
+            list.touch(memberNode->myPos);
+            swimDisseminate(memberNode->addr.getid(), memberNode->addr.getport(), memberNode->heartbeat);
+        }
+        return;
+    }
+
+    int pos = list.find(mle.getid(), mle.getport());
+    if (pos == -1) {
+        //Only news of an alive member adds it, a suspicion may be about one long gone
+        if (hb > 0) {
+            MemberListEntry heard(mle.getid(), mle.getport(), inc, par->globaltime);
+            swimAddMember(heard);
+        }
+        return;
+    }
+
+    //Tombstones stay failed
+    MemberRef known = list[pos];
+    if (known.getheartbeat() == 0) {
+        return;
+    }
+    if (hb == 0) {
+        swimMarkFailed(pos);
+    }
+    else if (hb > 0 && inc > known.getheartbeat()) {
+        known.setheartbeat(inc);
+        known.setsuspect(false);
+        list.touch(pos);
+        swimDisseminate(mle.getid(), mle.getport(), inc);
+    }
+    else if (hb < 0 && (inc > known.getheartbeat() || (inc == known.getheartbeat() && !known.getsuspect()))) {
+        known.setheartbeat(inc);
+        list.touch(pos);
+        swimSuspect(pos);
+    }
+    }
+
+/**
+ * FUNCTION NAME: swimAddMember
+ *
+ * DESCRIPTION: Add a member heard of for the first time, log it and pass the news on.
+ * 				Returns the position.
+ */
+    int MP1Node::swimAddMember(MemberListEntry &mle) {
+    MemberTable &list = memberNode->memberList;
+    int pos = list.insert(MemberListEntry(mle.getid(), mle.getport(), mle.getheartbeat(), par->globaltime));
+    log->logNodeAdd(&memberNode->addr, mle.getnodeid());
+    swimDisseminate(mle.getid(), mle.getport(), mle.getheartbeat());
+    queueTarget(mle.getnodeid());
+    return pos;
+    }
+
+/**
+ * FUNCTION NAME: swimSuspect
+ *
+ * DESCRIPTION: Suspect the member at pos and pass the news on. It is declared failed
+ * 				unless it refutes within the suspicion timeout.
+ */
+    void MP1Node::swimSuspect(int pos) {
+    MemberRef mle = memberNode->memberList[pos];
+    mle.setsuspect(true);
+    mle.settimestamp(par->globaltime);
+    TRACEEVENT(Address susAddr(mle.getnodeid());
+               cout << "Node ";
+               printAddress(&susAddr);
+               cout << " Suspected by ";
+               printAddress(&memberNode->addr));
+    swimDisseminate(mle.getid(), mle.getport(), -mle.getheartbeat());
+    }
+
+/**
+ * FUNCTION NAME: swimMarkFailed
+ *
+ * DESCRIPTION: Declare the member at pos failed, log it and pass the news on
+ */
+    void MP1Node::swimMarkFailed(int pos) {
+    MemberRef mle = memberNode->memberList[pos];
+    Address remAddr(mle.getnodeid());
+    mle.setheartbeat(0);
+    mle.setsuspect(false);
+    mle.settimestamp(par->globaltime);
+    memberNode->memberList.touch(pos);
+    TRACEEVENT(cout << "Node ";
+               printAddress(&remAddr);
+               cout << " Failed by ";
+               printAddress(&memberNode->addr));
+    log->logNodeRemove(&memberNode->addr, remAddr.nodeId());
+    Profiler::get().nodeRemoved(remAddr.getid(), par->globaltime);
+    swimDisseminate(remAddr.getid(), remAddr.getport(), 0);
+    }
+
+/**
+ * FUNCTION NAME: suspectTimeout
+ *
+ * DESCRIPTION: Ticks a suspected member has to refute before it is removed. SWIM scales
+ * 				it with the rounds an update takes to reach the whole group.
+ */
+    int MP1Node::suspectTimeout() {
+    if (par->SUSPECT_TIMEOUT > 0) {
+        return par->SUSPECT_TIMEOUT;
+    }
+    if (par->DETECTOR == SWIM_DETECTOR) {
+        return SWIM_PERIOD * max(3, (int)ceil(log2(memberNode->memberList.size() + 1)));
+    }
+    return TREMOVE - TFAIL;
+    }
+
+/**
+ * FUNCTION NAME: lowestLiveId
+ *
+ * DESCRIPTION: Lowest id among self and the live members not suspected
+ */
+    int MP1Node::lowestLiveId() {
+    MemberTable &list = memberNode->memberList;
+    int lowest = memberNode->addr.getid();
+    for (int k = 0; k < list.liveCount(); k++) {
+        MemberRef mle = list[list.liveEntry(k)];
+        if (!mle.getsuspect()) {
+            lowest = min(lowest, mle.getid());
+        }
+    }
+    return lowest;
+    }
+
+/**
+ * FUNCTION NAME: vouchFor
+ *
+ * DESCRIPTION: Whether an entry may be passed on to other members: it has not failed
+ * 				and its heartbeat was seen going up. Passing on entries only heard of
+ * 				second hand would let a failed member hop from joiner to joiner and
+ * 				come back to nodes that already forgot its tombstone.
+ */
+    bool MP1Node::vouchFor(MemberRef mle) {
+    return mle.getheartbeat() != 0 && (!mle.getunconfirmed() || par->globaltime - mle.gettimestamp() <= TFAIL);
+    }
+
+/**
+ * FUNCTION NAME: eraseMember
+ *
+ * DESCRIPTION: Drop the entry at pos from the membership list and forget what was
+ * 				sent to it. Returns the old position of the entry moved into pos, -1 if none.
+ */
+    int MP1Node::eraseMember(int pos) {
+    MemberTable &list = memberNode->memberList;
+    peerVersions.erase(list[pos].getnodeid());
+    int moved = list.erase(pos);
+    if (moved == memberNode->myPos) {
+        memberNode->myPos = pos;
+    }
+    return moved;
     }
 
 /**
@@ -504,7 +1504,7 @@ return 0;
  * DESCRIPTION: Function checks if the address is NULL
  */
     int MP1Node::isNullAddress(Address *addr) {
-        return (memcmp(addr->addr, NULLADDR, 6) == 0 ? 1 : 0);
+        return (addr->nodeId() == NodeId() ? 1 : 0);
     }
 
 /**
@@ -540,20 +1540,3 @@ return 0;
         printf("%d.%d.%d.%d:%d \n", addr->addr[0], addr->addr[1], addr->addr[2],
                addr->addr[3], *(short *) &addr->addr[4]);
     }
-
-/**
- * FUNCTION NAME: split
- *
- * DESC: Needed something to quickly split strings on delim.
- */
-void MP1Node::split(const string &s, char delim, vector<string> &elems) {
-    stringstream ss;
-    ss.str(s);
-    string item;
-    while (getline(ss, item, delim)) {
-        elems.push_back(item);
-    }
-}
-
-
-
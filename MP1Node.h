@@ -13,9 +13,10 @@
 #include "Params.h"
 #include "Member.h"
 #include "EmulNet.h"
-#include "Queue.h"
-#include "sstream"
-#include "random"
+#include "Message.h"
+#include "Trace.h"
+#include "Profiler.h"
+#include "Random.h"
 
 
 /**
@@ -23,28 +24,61 @@
  */
 #define TREMOVE 20
 #define TFAIL 5
-
-/*
- * Note: You can change/add any functions in MP1Node.{h,cpp}
- */
+// SWIM: ticks before a probe with no ack goes indirect, and the protocol period.
+// A direct ping is acked after 2 ticks, an indirect one after 4 more.
+#define SWIM_ACK_TIMEOUT 2
+#define SWIM_PERIOD 6
+// SWIM: updates piggybacked on each message, and retransmissions of an update
+// per log2 of the group size
+#define SWIM_PIGGYBACK 128
+#define SWIM_LAMBDA 3
+// Adaptive gossip: interval a node starts with, rounds without a near miss before
+// the interval is lengthened, weight of the last tick in the moving average of
+// gossip messages received per tick, and the largest loss the fanout makes up for
+#define GOSSIP_INTERVAL_START 5
+#define GOSSIP_CALM_ROUNDS 10
+#define GOSSIP_RATE_WEIGHT 0.02
+#define GOSSIP_MAX_LOSS 0.5
+// Anti-entropy: live members per digest bucket the initiator aims for
+#define DIGEST_BUCKET_MEMBERS 8
+// Messages taken out of the inbox at a time
+#define INBOX_BATCH 32
 
 /**
- * Message Types
+ * STRUCT NAME: SwimUpdate
+ *
+ * DESCRIPTION: Membership update waiting to be piggybacked on SWIM messages.
+ * 				heartbeat is the incarnation of an alive member, minus the
+ * 				incarnation of a suspected one, and 0 for a failed member.
  */
-enum MsgTypes{
-    JOINREQ,
-    JOINREP,
-    GOSSIP
-};
+typedef struct SwimUpdate {
+	int id;
+	short port;
+	long heartbeat;
+	int sendsLeft;
+	// Index of the update in the bucket of its sendsLeft
+	int bucketPos;
+}SwimUpdate;
 
 /**
- * STRUCT NAME: MessageHdr
+ * STRUCT NAME: ZoneSummary
  *
- * DESCRIPTION: Header and content of a message
+ * DESCRIPTION: What a node of another zone knows of this one in the hierarchical
+ * 				mode: the representative and its heartbeat. Kept small, as every
+ * 				node holds one per zone.
+ */
+typedef struct ZoneSummary {
+	int id;
+	short port;
+	// Heard of only second hand, not passed on until the heartbeat moves
+	bool unconfirmed;
+	int32_t heartbeat;
+	int timestamp;
+}ZoneSummary;
+
+/*
+ * Note: You can change/add any functions in MP1Node.{h,cpp}
  */
-typedef struct MessageHdr {
-	enum MsgTypes msgType;
-}MessageHdr;
 
 /**
  * CLASS NAME: MP1Node
@@ -57,7 +91,71 @@ private:
 	Log *log;
 	Params *par;
 	Member *memberNode;
-	char NULLADDR[6];
+	// Scratch buffer outgoing messages are encoded into
+	char *sendBuff;
+	int sendBuffSize;
+	// Latest entry version sent to each peer
+	unordered_map<NodeId, long> peerVersions;
+	// Positions of the entries going into a delta gossip
+	vector<int> deltaEntries;
+	// Positions of the entries whose timers ran out, or the timeout sweep found expired
+	vector<int> expired;
+	// Positions of the members picked to gossip to or probe, and the addresses
+	// a full gossip goes to
+	vector<int> picks;
+	vector<Address> sendTargets;
+	// TARGETS roundrobin: the members in a shuffled order, the next one to take,
+	// and the call of pickTargets each position was last picked in
+	vector<NodeId> targetOrder;
+	int targetNext;
+	vector<int> pickStamp;
+	int pickRound;
+	// Private random stream, so nodes can run on any thread and stay reproducible
+	Random rng;
+	// Gossip round timing: current interval and the ping counter of the next round
+	int gossipInterval;
+	int nextGossip;
+	// GOSSIP messages received this tick, and their moving average per tick
+	int gossipHeard;
+	double gossipRate;
+	// Fanout of the last round, what the others are expected to send too
+	int gossipLastFanout;
+	// Heartbeats merged since the last round that nearly timed out, and rounds in a row without any
+	int nearMisses;
+	int calmRounds;
+	// Gossip rounds since the last anti-entropy exchange, and the digest of the
+	// live members: count and XOR of the hashes per bucket
+	int antiEntropyRounds;
+	vector<int32_t> digestCount;
+	vector<uint32_t> digestHash;
+	// Hierarchical mode: the representative of each zone as last heard of,
+	// id 0 where none is known yet. Members of other zones are not tracked.
+	vector<ZoneSummary> zoneReps;
+	// Zones whose representatives a zone gossip picks from
+	vector<int> zonePicks;
+	// SWIM probe in progress: target position, sequence number and start tick
+	int probeTarget;
+	long probeSeq;
+	int probeStart;
+	bool probeAcked;
+	bool probeIndirect;
+	// SWIM updates still to be disseminated, in slots reused once sent out, and the
+	// slot of each member. Each bucket holds the slots with that many sends left,
+	// the newest last, -1 where an update was replaced since; swimTop is the highest
+	// bucket that may not be empty.
+	vector<SwimUpdate> swimUpdates;
+	vector<int> swimFree;
+	unordered_map<NodeId, int> swimSlot;
+	vector< vector<int> > swimBuckets;
+	int swimTop;
+	// Slots of the updates piggybacked on the message being built
+	vector<int> swimPicked;
+	// Event scheduler: last tick the per tick duties were done for, -1 before the
+	// first, and the tick a timer of nodeLoopOps is due next
+	int lastOps;
+	int wakeTick;
+	// Messages the inbox had no room for, still in the network
+	int recvWaiting;
 
 public:
 	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
@@ -65,20 +163,53 @@ public:
 		return memberNode;
 	}
 	int recvLoop();
-	static int enqueueWrapper(void *env, char *buff, int size);
 	void nodeStart(char *servaddrstr, short serverport);
 	int initThisNode(Address *joinaddr);
 	int introduceSelfToGroup(Address *joinAddress);
 	int finishUpThisNode();
 	void nodeLoop();
+	int getWakeTick() {
+		return wakeTick;
+	}
+	void catchUp();
+	int wakeHorizon();
 	void checkMessages();
 	bool recvCallBack(void *env, char *data, int size);
 	void nodeLoopOps();
+	int buildDeltaGossip(MemberRef peer);
+	double gossipLoss();
+	int gossipFanout(int alive);
+	void adaptGossipInterval();
+	void mergeGossip(MessageReader &reader, int first);
+	int digestBuckets();
+	void buildDigest(int buckets);
+	int appendDiffering(MessageWriter &msg, MessageReader &remote, int buckets);
+	void sendDigest(Address *to);
+	void digestReceive(MessageReader &reader, Address *from);
+	bool inMyZone(int id);
+	void zoneMerge(MemberListEntry &mle, bool firstHand);
+	void appendZoneSummaries(MessageWriter &msg);
+	void sendZoneGossip();
+	int zonesKnown();
+	long zoneMemoryBytes();
+	void swimLoopOps();
+	void swimReceive(MessageReader &reader);
+	void swimSend(enum MsgTypes type, Address *to, int originId, short originPort, long seq);
+	void swimDisseminate(int id, short port, long heartbeat);
+	void swimUpdate(MemberListEntry &mle);
+	int swimAddMember(MemberListEntry &mle);
+	void swimSuspect(int pos);
+	void swimMarkFailed(int pos);
+	int suspectTimeout();
+	int lowestLiveId();
+	bool vouchFor(MemberRef mle);
+	template<class Accept> int pickTargets(int k, Accept accept, vector<int> &out);
+	void queueTarget(NodeId node);
+	int eraseMember(int pos);
 	int isNullAddress(Address *addr);
 	Address getJoinAddress();
 	void initMemberListTable(Member *memberNode);
 	void printAddress(Address *addr);
-    void split(const string &s, char delim, vector<string> &elems);
 	virtual ~MP1Node();
 };
 
@@ -6,10 +6,9 @@
 
 #include "Member.h"
 
-/**
- * Constructor
- */
-q_elt::q_elt(void *elt, int size): elt(elt), size(size) {}
+#ifdef MEMBER_SIMD_SWEEP
+#include <emmintrin.h>
+#endif
 
 /**
  * Copy constructor
@@ -40,12 +39,12 @@ bool Address::operator ==(const Address& anotherAddress) {
 /**
  * Constructor
  */
-MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp) {}
+MemberListEntry::MemberListEntry(int id, short port, long heartbeat, long timestamp): id(id), port(port), heartbeat(heartbeat), timestamp(timestamp), suspect(false), unconfirmed(false) {}
 
 /**
  * Constructor
  */
-MemberListEntry::MemberListEntry(int id, short port): id(id), port(port) {}
+MemberListEntry::MemberListEntry(int id, short port): id(id), port(port), suspect(false), unconfirmed(false) {}
 
 /**
  * Copy constructor
@@ -55,6 +54,8 @@ MemberListEntry::MemberListEntry(const MemberListEntry &anotherMLE) {
 	this->id = anotherMLE.id;
 	this->port = anotherMLE.port;
 	this->timestamp = anotherMLE.timestamp;
+	this->suspect = anotherMLE.suspect;
+	this->unconfirmed = anotherMLE.unconfirmed;
 }
 
 /**
@@ -66,6 +67,8 @@ MemberListEntry& MemberListEntry::operator =(const MemberListEntry &anotherMLE)
 	swap(id, temp.id);
 	swap(port, temp.port);
 	swap(timestamp, temp.timestamp);
+	swap(suspect, temp.suspect);
+	swap(unconfirmed, temp.unconfirmed);
 	return *this;
 }
 
@@ -87,6 +90,15 @@ short MemberListEntry::getport() {
 	return port;
 }
 
+/**
+ * FUNCTION NAME: getnodeid
+ *
+ * DESCRIPTION: getter
+ */
+NodeId MemberListEntry::getnodeid() {
+	return NodeId(id, port);
+}
+
 /**
  * FUNCTION NAME: getheartbeat
  *
@@ -105,6 +117,24 @@ long MemberListEntry::gettimestamp() {
 	return timestamp;
 }
 
+/**
+ * FUNCTION NAME: getsuspect
+ *
+ * DESCRIPTION: getter
+ */
+bool MemberListEntry::getsuspect() {
+	return suspect;
+}
+
+/**
+ * FUNCTION NAME: getunconfirmed
+ *
+ * DESCRIPTION: getter
+ */
+bool MemberListEntry::getunconfirmed() {
+	return unconfirmed;
+}
+
 /**
  * FUNCTION NAME: setid
  *
@@ -141,6 +171,554 @@ void MemberListEntry::settimestamp(long timestamp) {
 	this->timestamp = timestamp;
 }
 
+/**
+ * FUNCTION NAME: setsuspect
+ *
+ * DESCRIPTION: setter
+ */
+void MemberListEntry::setsuspect(bool suspect) {
+	this->suspect = suspect;
+}
+
+/**
+ * FUNCTION NAME: setunconfirmed
+ *
+ * DESCRIPTION: setter
+ */
+void MemberListEntry::setunconfirmed(bool unconfirmed) {
+	this->unconfirmed = unconfirmed;
+}
+
+/**
+ * Constructor
+ */
+MemberTable::MemberTable(): clock(0), slots(16, -1), shift(64 - 4), timed(false), suspectAge(0), failAge(0), forgetAge(0) {}
+
+/**
+ * FUNCTION NAME: homeOf
+ *
+ * DESCRIPTION: Slot the probe for node starts at
+ */
+int MemberTable::homeOf(NodeId node) {
+	return (int)(node.hash() >> shift);
+}
+
+/**
+ * FUNCTION NAME: slotOf
+ *
+ * DESCRIPTION: Linear probe for the slot holding node, or the empty slot it would go in
+ */
+int MemberTable::slotOf(NodeId node) {
+	int mask = (int)slots.size() - 1;
+	int slot = homeOf(node);
+	while ( slots[slot] != -1 ) {
+		if ( NodeId(ids[slots[slot]], ports[slots[slot]]) == node ) {
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+/**
+ * FUNCTION NAME: rehash
+ *
+ * DESCRIPTION: Resize the hash table to nslots, a power of two, and reinsert every entry
+ */
+void MemberTable::rehash(int nslots) {
+	vector<int>(nslots, -1).swap(slots);
+	shift = 64;
+	while ( nslots > 1 ) {
+		nslots >>= 1;
+		shift--;
+	}
+	for ( int i = 0; i < size(); i++ ) {
+		slots[slotOf(NodeId(ids[i], ports[i]))] = i;
+	}
+}
+
+/**
+ * FUNCTION NAME: store
+ *
+ * DESCRIPTION: Write entry into the arrays at index
+ */
+void MemberTable::store(int index, const MemberListEntry &entry) {
+	ids[index] = entry.id;
+	ports[index] = entry.port;
+	timestamps[index] = (int32_t)entry.timestamp;
+	flags[index] = (flags[index] & (SUSPECT_TIMER | EXPIRE_TIMER))
+				   | (entry.suspect ? MEMBER_SUSPECT : 0) | (entry.unconfirmed ? MEMBER_UNCONFIRMED : 0);
+	setheartbeat(index, (int32_t)entry.heartbeat);
+	reschedule(index);
+}
+
+/**
+ * FUNCTION NAME: setheartbeat
+ *
+ * DESCRIPTION: Set the heartbeat of the entry at index, adding it to the live
+ * 				index or taking it out when it turns into a tombstone or back
+ */
+void MemberTable::setheartbeat(int index, int32_t heartbeat) {
+	bool was = liveAt[index] != -1;
+	heartbeats[index] = heartbeat;
+	if ( heartbeat != 0 && !was ) {
+		liveAt[index] = (int)live.size();
+		live.push_back(index);
+	}
+	else if ( heartbeat == 0 && was ) {
+		int at = liveAt[index];
+		live[at] = live.back();
+		liveAt[live[at]] = at;
+		live.pop_back();
+		liveAt[index] = -1;
+	}
+	if ( timed && (was != (heartbeat != 0) || !armed(index)) ) {
+		reschedule(index);
+	}
+}
+
+/**
+ * FUNCTION NAME: suspectDue
+ *
+ * DESCRIPTION: Tick the entry at index is suspected at, INT_MAX if it is not
+ * 				watched for that: a tombstone, or suspected already
+ */
+int MemberTable::suspectDue(int index) {
+	if ( heartbeats[index] == 0 || (flags[index] & MEMBER_SUSPECT) ) {
+		return INT_MAX;
+	}
+	return timestamps[index] + suspectAge + 1;
+}
+
+/**
+ * FUNCTION NAME: expireDue
+ *
+ * DESCRIPTION: Tick the entry at index fails at, or is forgotten at for a tombstone
+ */
+int MemberTable::expireDue(int index) {
+	return timestamps[index] + (heartbeats[index] == 0 ? forgetAge : failAge) + 1;
+}
+
+/**
+ * FUNCTION NAME: pullTimer
+ *
+ * DESCRIPTION: Make the timer bit of the entry at index fire by tick, leaving it be
+ * 				if it fires sooner
+ */
+void MemberTable::pullTimer(TimerWheel &wheel, uint8_t bit, int index, int tick) {
+	if ( tick == INT_MAX ) {
+		return;
+	}
+	if ( !(flags[index] & bit) || wheel.deadline(index) > tick ) {
+		wheel.schedule(index, tick);
+		flags[index] |= bit;
+	}
+}
+
+/**
+ * FUNCTION NAME: reschedule
+ *
+ * DESCRIPTION: Bring the timers of the entry at index in line with it. Timers are
+ * 				only ever moved earlier here: a heartbeat pushes the deadline of a
+ * 				member back on nearly every tick, and relinking the timer each time
+ * 				would cost more than sweeping the table. A timer that fires before
+ * 				the deadline of its entry is set again then, see expire(). The
+ * 				setters only call this when a deadline may have moved earlier or
+ * 				a timer is missing.
+ */
+void MemberTable::reschedule(int index) {
+	if ( !timed ) {
+		return;
+	}
+	pullTimer(suspectWheel, SUSPECT_TIMER, index, suspectDue(index));
+	pullTimer(expireWheel, EXPIRE_TIMER, index, expireDue(index));
+}
+
+/**
+ * FUNCTION NAME: setTimeouts
+ *
+ * DESCRIPTION: Keep a timer per entry from now on, for the ages expire() checks
+ */
+void MemberTable::setTimeouts(int suspectAge, int failAge, int forgetAge) {
+	timed = true;
+	this->suspectAge = suspectAge;
+	this->failAge = failAge;
+	this->forgetAge = forgetAge;
+	suspectWheel.resize(size());
+	expireWheel.resize(size());
+	for ( int i = 0; i < size(); i++ ) {
+		reschedule(i);
+	}
+}
+
+/**
+ * FUNCTION NAME: expire
+ *
+ * DESCRIPTION: Move the timers on to tick now and put the positions of the entries
+ * 				that timed out by then into due, in ascending order: live entries
+ * 				older than suspectAge or failAge, and tombstones older than
+ * 				forgetAge. Only the entries whose timers fired are looked at; those
+ * 				heard from since are set to fire at their new deadline. An entry
+ * 				found is not found again until it changes.
+ * 				Returns the number of entries in due.
+ */
+int MemberTable::expire(int now, vector<int> &due) {
+	due.clear();
+	fired.clear();
+	suspectWheel.advance(now, fired);
+	for ( int k = 0; k < (int)fired.size(); k++ ) {
+		fire(suspectWheel, SUSPECT_TIMER, fired[k], suspectDue(fired[k]), now, due);
+	}
+	fired.clear();
+	expireWheel.advance(now, fired);
+	for ( int k = 0; k < (int)fired.size(); k++ ) {
+		fire(expireWheel, EXPIRE_TIMER, fired[k], expireDue(fired[k]), now, due);
+	}
+	sort(due.begin(), due.end());
+	due.erase(unique(due.begin(), due.end()), due.end());
+	return (int)due.size();
+}
+
+/**
+ * FUNCTION NAME: nextExpiry
+ *
+ * DESCRIPTION: First tick an entry fails or is forgotten at, INT_MAX if none will.
+ * 				The timers due first whose entries were heard from since are set
+ * 				to their new deadline on the way.
+ */
+int MemberTable::nextExpiry() {
+	for ( ;; ) {
+		int at = expireWheel.earliest(fired);
+		bool real = at == INT_MAX;
+		for ( int k = 0; k < (int)fired.size(); k++ ) {
+			int deadline = expireDue(fired[k]);
+			if ( deadline <= at ) {
+				real = true;
+			}
+			else {
+				expireWheel.schedule(fired[k], deadline);
+			}
+		}
+		if ( real ) {
+			return at;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: fire
+ *
+ * DESCRIPTION: The timer bit of the entry at index fired: add the entry to due if
+ * 				its deadline at has passed, set the timer again if not
+ */
+void MemberTable::fire(TimerWheel &wheel, uint8_t bit, int index, int at, int now, vector<int> &due) {
+	flags[index] &= ~bit;
+	if ( at <= now ) {
+		due.push_back(index);
+	}
+	else if ( at != INT_MAX ) {
+		wheel.schedule(index, at);
+		flags[index] |= bit;
+	}
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Position of the entry for node, -1 if it is not in the table
+ */
+int MemberTable::find(NodeId node) {
+	return slots[slotOf(node)];
+}
+
+/**
+ * FUNCTION NAME: insert
+ *
+ * DESCRIPTION: Add an entry, or overwrite the existing one for the same id:port.
+ * 				Either way the entry is marked as changed.
+ * 				Returns the position of the entry.
+ */
+int MemberTable::insert(const MemberListEntry &entry) {
+	int slot = slotOf(NodeId(entry.id, entry.port));
+	if ( slots[slot] != -1 ) {
+		store(slots[slot], entry);
+		touch(slots[slot]);
+		return slots[slot];
+	}
+	int pos = size();
+	ids.push_back(0);
+	ports.push_back(0);
+	heartbeats.push_back(0);
+	timestamps.push_back(0);
+	flags.push_back(0);
+	liveAt.push_back(-1);
+	if ( timed ) {
+		suspectWheel.resize(pos + 1);
+		expireWheel.resize(pos + 1);
+	}
+	store(pos, entry);
+	versions.push_back(++clock);
+	// Keep the load factor under 1/2
+	if ( 2 * size() > (int)slots.size() ) {
+		rehash((int)slots.size() * 2);
+		return pos;
+	}
+	slots[slot] = pos;
+	return pos;
+}
+
+/**
+ * FUNCTION NAME: erase
+ *
+ * DESCRIPTION: Remove the entry at pos. The last entry is moved into its place,
+ * 				so the position of that one changes from size() - 1 to pos.
+ * 				Returns the old position of the moved entry, -1 if none moved.
+ */
+int MemberTable::erase(int pos) {
+	int mask = (int)slots.size() - 1;
+	int last = size() - 1;
+	int hole = slotOf(NodeId(ids[pos], ports[pos]));
+	setheartbeat(pos, 0);
+
+	// Shift later entries of the probe sequence back so none is cut off from its home slot
+	for ( int j = (hole + 1) & mask; slots[j] != -1; j = (j + 1) & mask ) {
+		int home = homeOf(NodeId(ids[slots[j]], ports[slots[j]]));
+		if ( ((j - home) & mask) >= ((j - hole) & mask) ) {
+			slots[hole] = slots[j];
+			hole = j;
+		}
+	}
+	slots[hole] = -1;
+
+	int moved = -1;
+	if ( pos != last ) {
+		ids[pos] = ids[last];
+		ports[pos] = ports[last];
+		heartbeats[pos] = heartbeats[last];
+		timestamps[pos] = timestamps[last];
+		flags[pos] = flags[last];
+		versions[pos] = versions[last];
+		liveAt[pos] = liveAt[last];
+		if ( liveAt[pos] != -1 ) {
+			live[liveAt[pos]] = pos;
+		}
+		slots[slotOf(NodeId(ids[pos], ports[pos]))] = pos;
+		moved = last;
+	}
+	if ( timed ) {
+		suspectWheel.move(last, pos);
+		expireWheel.move(last, pos);
+		suspectWheel.resize(last);
+		expireWheel.resize(last);
+	}
+	ids.pop_back();
+	ports.pop_back();
+	heartbeats.pop_back();
+	timestamps.pop_back();
+	flags.pop_back();
+	versions.pop_back();
+	liveAt.pop_back();
+
+	// Give the memory back once the load factor is under 1/8, halving
+	// leaves it under 1/4 so a few inserts do not grow it again
+	if ( (int)slots.size() > 16 && 8 * size() < (int)slots.size() ) {
+		ids.shrink_to_fit();
+		ports.shrink_to_fit();
+		heartbeats.shrink_to_fit();
+		timestamps.shrink_to_fit();
+		flags.shrink_to_fit();
+		versions.shrink_to_fit();
+		live.shrink_to_fit();
+		liveAt.shrink_to_fit();
+		rehash((int)slots.size() / 2);
+	}
+	return moved;
+}
+
+/**
+ * FUNCTION NAME: memoryBytes
+ *
+ * DESCRIPTION: Bytes allocated for the entries and the hash table
+ */
+long MemberTable::memoryBytes() {
+	return (long)(ids.capacity() * sizeof(int32_t) + ports.capacity() * sizeof(int16_t)
+				  + heartbeats.capacity() * sizeof(int32_t) + timestamps.capacity() * sizeof(int32_t)
+				  + flags.capacity() * sizeof(uint8_t) + versions.capacity() * sizeof(long)
+				  + (live.capacity() + liveAt.capacity()) * sizeof(int)
+				  + slots.capacity() * sizeof(int)
+				  + (timed ? suspectWheel.memoryBytes() + expireWheel.memoryBytes() : 0));
+}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Remove every entry. The clock keeps running so versions
+ * 				handed out before stay older than any handed out after.
+ */
+void MemberTable::clear() {
+	ids.clear();
+	ports.clear();
+	heartbeats.clear();
+	timestamps.clear();
+	flags.clear();
+	versions.clear();
+	live.clear();
+	liveAt.clear();
+	slots.assign(16, -1);
+	shift = 64 - 4;
+	suspectWheel.clear();
+	expireWheel.clear();
+	suspectWheel.resize(0);
+	expireWheel.resize(0);
+}
+
+/**
+ * FUNCTION NAME: sweep
+ *
+ * DESCRIPTION: Find the entries that timed out by tick now, in one pass over the table.
+ * 				An entry is watched if it is live, or with suspectsOnly if it is live
+ * 				and suspected. The positions of the watched entries older than liveAge
+ * 				and of the tombstones older than deadAge go into expired, in ascending
+ * 				order; res gets the rest of what a timeout check needs.
+ * 				Returns the number of expired entries.
+ */
+int MemberTable::sweep(int now, int liveAge, int deadAge, bool suspectsOnly, vector<int> &expired, SweepResult &res) {
+#ifdef MEMBER_SIMD_SWEEP
+	return sweepSimd(now, liveAge, deadAge, suspectsOnly, expired, res);
+#else
+	return sweepScalar(now, liveAge, deadAge, suspectsOnly, expired, res);
+#endif
+}
+
+/**
+ * FUNCTION NAME: sweepScalar
+ *
+ * DESCRIPTION: sweep, one entry at a time
+ */
+int MemberTable::sweepScalar(int now, int liveAge, int deadAge, bool suspectsOnly, vector<int> &expired, SweepResult &res) {
+	expired.clear();
+	res.live = 0;
+	res.oldestWatched = INT32_MAX;
+	res.oldestDead = INT32_MAX;
+	res.lowestFresh = INT32_MAX;
+	sweepFrom(0, now, liveAge, deadAge, suspectsOnly ? MEMBER_SUSPECT : 0, expired, res);
+	return (int)expired.size();
+}
+
+/**
+ * FUNCTION NAME: sweepFrom
+ *
+ * DESCRIPTION: The scalar loop of sweep over the entries from position i on,
+ * 				adding to what res and expired hold already
+ */
+void MemberTable::sweepFrom(int i, int now, int liveAge, int deadAge, uint8_t watchMask, vector<int> &expired, SweepResult &res) {
+	int n = size();
+	for ( ; i < n; i++ ) {
+		int32_t ts = timestamps[i];
+		int age = now - ts;
+		if ( heartbeats[i] == 0 ) {
+			if ( age > deadAge ) {
+				expired.push_back(i);
+			}
+			else {
+				res.oldestDead = min(res.oldestDead, ts);
+			}
+			continue;
+		}
+		res.live++;
+		if ( (flags[i] & watchMask) != watchMask ) {
+			continue;
+		}
+		if ( age > liveAge ) {
+			expired.push_back(i);
+			continue;
+		}
+		res.oldestWatched = min(res.oldestWatched, ts);
+		if ( !(flags[i] & MEMBER_SUSPECT) ) {
+			res.lowestFresh = min(res.lowestFresh, ids[i]);
+		}
+	}
+}
+
+#ifdef MEMBER_SIMD_SWEEP
+/**
+ * FUNCTION NAME: sweepSimd
+ *
+ * DESCRIPTION: sweep, four entries at a time. SSE2 has no 32 bit min, it is
+ * 				built from a compare and a blend. The few expired entries are
+ * 				picked out of the compare mask one bit at a time.
+ */
+int MemberTable::sweepSimd(int now, int liveAge, int deadAge, bool suspectsOnly, vector<int> &expired, SweepResult &res) {
+	uint8_t watchMask = suspectsOnly ? MEMBER_SUSPECT : 0;
+	int n = size();
+	expired.clear();
+
+	// An entry is older than age when its timestamp is below now - age
+	const __m128i liveCut = _mm_set1_epi32(now - liveAge);
+	const __m128i deadCut = _mm_set1_epi32(now - deadAge);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i none = _mm_set1_epi32(INT32_MAX);
+	const __m128i watchBits = _mm_set1_epi32(watchMask);
+	const __m128i suspectBit = _mm_set1_epi32(MEMBER_SUSPECT);
+	__m128i live = zero;
+	__m128i oldestWatched = none;
+	__m128i oldestDead = none;
+	__m128i lowestFresh = none;
+
+	int i = 0;
+	for ( ; i + 4 <= n; i += 4 ) {
+		__m128i hb = _mm_loadu_si128((const __m128i *)&heartbeats[i]);
+		__m128i ts = _mm_loadu_si128((const __m128i *)&timestamps[i]);
+		__m128i id = _mm_loadu_si128((const __m128i *)&ids[i]);
+		uint32_t f4;
+		memcpy(&f4, &flags[i], sizeof(f4));
+		// Widen the four flag bytes to one per lane
+		__m128i fl = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)f4), zero), zero);
+
+		__m128i dead = _mm_cmpeq_epi32(hb, zero);
+		__m128i alive = _mm_andnot_si128(dead, _mm_set1_epi32(-1));
+		__m128i watched = _mm_and_si128(alive, _mm_cmpeq_epi32(_mm_and_si128(fl, watchBits), watchBits));
+		__m128i liveOld = _mm_cmplt_epi32(ts, liveCut);
+		__m128i deadOld = _mm_cmplt_epi32(ts, deadCut);
+		__m128i gone = _mm_or_si128(_mm_and_si128(watched, liveOld), _mm_and_si128(dead, deadOld));
+
+		live = _mm_sub_epi32(live, alive);
+		__m128i keepWatched = _mm_andnot_si128(liveOld, watched);
+		__m128i keepDead = _mm_andnot_si128(deadOld, dead);
+		__m128i fresh = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(fl, suspectBit), suspectBit), keepWatched);
+
+		// min(acc, v) over the lanes in mask: take v where mask and v < acc
+		__m128i take = _mm_and_si128(keepWatched, _mm_cmplt_epi32(ts, oldestWatched));
+		oldestWatched = _mm_or_si128(_mm_and_si128(take, ts), _mm_andnot_si128(take, oldestWatched));
+		take = _mm_and_si128(keepDead, _mm_cmplt_epi32(ts, oldestDead));
+		oldestDead = _mm_or_si128(_mm_and_si128(take, ts), _mm_andnot_si128(take, oldestDead));
+		take = _mm_and_si128(fresh, _mm_cmplt_epi32(id, lowestFresh));
+		lowestFresh = _mm_or_si128(_mm_and_si128(take, id), _mm_andnot_si128(take, lowestFresh));
+
+		int bits = _mm_movemask_ps(_mm_castsi128_ps(gone));
+		while ( bits ) {
+			int lane = __builtin_ctz(bits);
+			expired.push_back(i + lane);
+			bits &= bits - 1;
+		}
+	}
+
+	int32_t lanes[4][4];
+	_mm_storeu_si128((__m128i *)lanes[0], live);
+	_mm_storeu_si128((__m128i *)lanes[1], oldestWatched);
+	_mm_storeu_si128((__m128i *)lanes[2], oldestDead);
+	_mm_storeu_si128((__m128i *)lanes[3], lowestFresh);
+	res.live = lanes[0][0] + lanes[0][1] + lanes[0][2] + lanes[0][3];
+	res.oldestWatched = min(min(lanes[1][0], lanes[1][1]), min(lanes[1][2], lanes[1][3]));
+	res.oldestDead = min(min(lanes[2][0], lanes[2][1]), min(lanes[2][2], lanes[2][3]));
+	res.lowestFresh = min(min(lanes[3][0], lanes[3][1]), min(lanes[3][2], lanes[3][3]));
+
+	// The last few entries
+	sweepFrom(i, now, liveAge, deadAge, watchMask, expired, res);
+	return (int)expired.size();
+}
+#endif
+
 /**
  * Copy Constructor
  */
@@ -155,7 +733,6 @@ Member::Member(const Member &anotherMember) {
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
 	this->myPos = anotherMember.myPos;
-	this->mp1q = anotherMember.mp1q;
 }
 
 /**
@@ -172,6 +749,5 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
 	this->myPos = anotherMember.myPos;
-	this->mp1q = anotherMember.mp1q;
 	return *this;
 }
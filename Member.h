@@ -8,18 +8,74 @@
 #define MEMBER_H_
 
 #include "stdincludes.h"
+#include "TimerWheel.h"
+#include "Inbox.h"
 
 /**
- * CLASS NAME: q_elt
+ * CLASS NAME: NodeId
  *
- * DESCRIPTION: Entry in the queue
+ * DESCRIPTION: Name of a node as one integer: the id in the high bits and the
+ * 				port in the low 16. Trivially copyable, so it is compared,
+ * 				hashed and stored as the integer it is, and formatted into a
+ * 				caller buffer rather than a string.
  */
-class q_elt {
+class NodeId {
+private:
+	uint64_t bits;
 public:
-	void *elt;
-	int size;
-	q_elt(void *elt, int size);
+	// Longest text format() writes, the terminating 0 included
+	static const int TEXT_SIZE = 20;
+	NodeId(): bits(0) {}
+	NodeId(int id, short port): bits(((uint64_t)(uint32_t)id << 16) | (uint16_t)port) {}
+	int getid() const {
+		return (int)(uint32_t)(bits >> 16);
+	}
+	short getport() const {
+		return (short)(uint16_t)bits;
+	}
+	uint64_t value() const {
+		return bits;
+	}
+	// Fibonacci hash, take the high bits
+	uint64_t hash() const {
+		return bits * 0x9E3779B97F4A7C15ULL;
+	}
+	bool operator ==(const NodeId &other) const {
+		return bits == other.bits;
+	}
+	bool operator !=(const NodeId &other) const {
+		return bits != other.bits;
+	}
+	bool operator <(const NodeId &other) const {
+		return bits < other.bits;
+	}
+	// The 6 bytes of an Address: id then port, in host order
+	void toBytes(char *out) const {
+		int id = getid();
+		short port = getport();
+		memcpy(out, &id, sizeof(int));
+		memcpy(out + 4, &port, sizeof(short));
+	}
+	static NodeId fromBytes(const char *in) {
+		int id;
+		short port;
+		memcpy(&id, in, sizeof(int));
+		memcpy(&port, in + 4, sizeof(short));
+		return NodeId(id, port);
+	}
+	// "id:port" into out, which holds TEXT_SIZE bytes. Returns the length.
+	int format(char *out) const {
+		return snprintf(out, TEXT_SIZE, "%d:%d", getid(), getport());
+	}
+};
+
+namespace std {
+template<> struct hash<NodeId> {
+	size_t operator ()(const NodeId &node) const {
+		return (size_t)(node.hash() >> 32);
+	}
 };
+}
 
 /**
  * CLASS NAME: Address
@@ -42,12 +98,30 @@ public:
 		memcpy(&addr[0], &id, sizeof(int));
 		memcpy(&addr[4], &port, sizeof(short));
 	}
-	string getAddress() {
-		int id = 0;
-		short port;
+	Address(int id, short port) {
+		memcpy(&addr[0], &id, sizeof(int));
+		memcpy(&addr[4], &port, sizeof(short));
+	}
+	Address(NodeId node) {
+		node.toBytes(addr);
+	}
+	NodeId nodeId() {
+		return NodeId::fromBytes(addr);
+	}
+	int getid() {
+		int id;
 		memcpy(&id, &addr[0], sizeof(int));
+		return id;
+	}
+	short getport() {
+		short port;
 		memcpy(&port, &addr[4], sizeof(short));
-		return to_string(id) + ":" + to_string(port);
+		return port;
+	}
+	string getAddress() {
+		char text[NodeId::TEXT_SIZE];
+		nodeId().format(text);
+		return text;
 	}
 	void init() {
 		memset(&addr, 0, sizeof(addr));
@@ -65,21 +139,261 @@ public:
 	short port;
 	long heartbeat;
 	long timestamp;
+	// Suspected to have failed but not removed yet. A failed member is kept
+	// as a tombstone with heartbeat 0 for a while.
+	bool suspect;
+	// Heard of only second hand so far, with no newer heartbeat since. Such
+	// news may be old and is not passed on.
+	bool unconfirmed;
 	MemberListEntry(int id, short port, long heartbeat, long timestamp);
 	MemberListEntry(int id, short port);
-	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0) {}
+	MemberListEntry(): id(0), port(0), heartbeat(0), timestamp(0), suspect(false), unconfirmed(false) {}
 	MemberListEntry(const MemberListEntry &anotherMLE);
 	MemberListEntry& operator =(const MemberListEntry &anotherMLE);
 	int getid();
 	short getport();
+	NodeId getnodeid();
 	long getheartbeat();
 	long gettimestamp();
+	bool getsuspect();
+	bool getunconfirmed();
 	void setid(int id);
 	void setport(short port);
 	void setheartbeat(long hearbeat);
 	void settimestamp(long timestamp);
+	void setsuspect(bool suspect);
+	void setunconfirmed(bool unconfirmed);
 };
 
+/*
+ * The timeout sweep of MemberTable runs four entries at a time with SSE2, which
+ * every x86-64 compiler turns on. Build with -DMEMBER_SCALAR_SWEEP, or for another
+ * architecture, to get the plain loop.
+ */
+#if defined(__SSE2__) && !defined(MEMBER_SCALAR_SWEEP)
+#define MEMBER_SIMD_SWEEP
+#endif
+
+/**
+ * STRUCT NAME: SweepResult
+ *
+ * DESCRIPTION: What MemberTable::sweep found besides the expired entries. The
+ * 				oldest timestamps and the lowest id are INT32_MAX when no entry
+ * 				qualifies; all three leave out the expired entries.
+ */
+typedef struct SweepResult {
+	// Entries with a heartbeat, the own one included
+	int live;
+	// Oldest timestamp of the watched entries
+	int32_t oldestWatched;
+	// Oldest timestamp of the tombstones
+	int32_t oldestDead;
+	// Lowest id of the live entries not suspected
+	int32_t lowestFresh;
+}SweepResult;
+
+class MemberRef;
+
+/**
+ * CLASS NAME: MemberTable
+ *
+ * DESCRIPTION: Membership table. Entries are stored densely, one array per
+ * 				field, and indexed by NodeId through an open addressing hash
+ * 				table, so lookups do not depend on the position of an entry.
+ * 				Entries keep their position until an erase moves the last one
+ * 				into a gap, and storage shrinks back when most entries have
+ * 				been erased. The per tick timeout check only reads the
+ * 				heartbeat, timestamp and flag arrays, see sweep(). With
+ * 				setTimeouts() the table keeps a timer per entry instead, so
+ * 				the check only costs the entries that time out, see expire().
+ */
+class MemberTable {
+private:
+	friend class MemberRef;
+	vector<int32_t> ids;
+	vector<int16_t> ports;
+	vector<int32_t> heartbeats;
+	vector<int32_t> timestamps;
+	// MEMBER_SUSPECT and MEMBER_UNCONFIRMED bits of each entry, and the
+	// SUSPECT_TIMER and EXPIRE_TIMER bits of the timers it has set
+	vector<uint8_t> flags;
+	// Version of each entry, stamped from clock whenever the entry changes
+	vector<long> versions;
+	long clock;
+	// Positions of the entries with a heartbeat, in no particular order, and
+	// the place of each entry in it, -1 for tombstones
+	vector<int> live;
+	vector<int> liveAt;
+	// Index into the entries for each hash slot, -1 if the slot is empty
+	vector<int> slots;
+	int shift;
+	// Timers of the entries once setTimeouts is called: suspicion of the live
+	// entries, and failure of the live ones or forgetting of the tombstones
+	static const uint8_t SUSPECT_TIMER = 4;
+	static const uint8_t EXPIRE_TIMER = 8;
+	bool timed;
+	int suspectAge;
+	int failAge;
+	int forgetAge;
+	TimerWheel suspectWheel;
+	TimerWheel expireWheel;
+	vector<int> fired;
+	int homeOf(NodeId node);
+	int slotOf(NodeId node);
+	void rehash(int nslots);
+	void store(int index, const MemberListEntry &entry);
+	void setheartbeat(int index, int32_t heartbeat);
+	void reschedule(int index);
+	int suspectDue(int index);
+	int expireDue(int index);
+	void pullTimer(TimerWheel &wheel, uint8_t bit, int index, int tick);
+	void fire(TimerWheel &wheel, uint8_t bit, int index, int at, int now, vector<int> &due);
+	// Whether the entry at index has every timer it needs set
+	bool armed(int index) {
+		uint8_t f = flags[index];
+		return (f & EXPIRE_TIMER) && ((f & SUSPECT_TIMER) || (f & MEMBER_SUSPECT) || heartbeats[index] == 0);
+	}
+	void sweepFrom(int i, int now, int liveAge, int deadAge, uint8_t watchMask, vector<int> &expired, SweepResult &res);
+public:
+	static const uint8_t MEMBER_SUSPECT = 1;
+	static const uint8_t MEMBER_UNCONFIRMED = 2;
+	MemberTable();
+	int find(NodeId node);
+	int find(int id, short port) {
+		return find(NodeId(id, port));
+	}
+	int insert(const MemberListEntry &entry);
+	int erase(int pos);
+	void clear();
+	int size() {
+		return (int)ids.size();
+	}
+	inline MemberRef operator [](int index);
+	// Mark the entry at index as changed
+	void touch(int index) {
+		versions[index] = ++clock;
+	}
+	long getversion(int index) {
+		return versions[index];
+	}
+	long getclock() {
+		return clock;
+	}
+	long memoryBytes();
+	// Entries with a heartbeat
+	int liveCount() {
+		return (int)live.size();
+	}
+	int liveEntry(int k) {
+		return live[k];
+	}
+	template<class Accept, class Rng> int sample(int k, Accept accept, Rng &rng, vector<int> &out);
+	int sweep(int now, int liveAge, int deadAge, bool suspectsOnly, vector<int> &expired, SweepResult &res);
+	int sweepScalar(int now, int liveAge, int deadAge, bool suspectsOnly, vector<int> &expired, SweepResult &res);
+#ifdef MEMBER_SIMD_SWEEP
+	int sweepSimd(int now, int liveAge, int deadAge, bool suspectsOnly, vector<int> &expired, SweepResult &res);
+#endif
+	void setTimeouts(int suspectAge, int failAge, int forgetAge);
+	int expire(int now, vector<int> &due);
+	int nextExpiry();
+};
+
+/**
+ * CLASS NAME: MemberRef
+ *
+ * DESCRIPTION: An entry of a MemberTable, read and written in place with the
+ * 				getters and setters of MemberListEntry. Stays valid until the
+ * 				table inserts or erases.
+ */
+class MemberRef {
+private:
+	MemberTable *table;
+	int index;
+	void setflag(uint8_t flag, bool on) {
+		uint8_t &f = table->flags[index];
+		f = on ? (f | flag) : (f & ~flag);
+	}
+public:
+	MemberRef(MemberTable *table, int index): table(table), index(index) {}
+	int getid() {
+		return table->ids[index];
+	}
+	short getport() {
+		return table->ports[index];
+	}
+	NodeId getnodeid() {
+		return NodeId(table->ids[index], table->ports[index]);
+	}
+	long getheartbeat() {
+		return table->heartbeats[index];
+	}
+	long gettimestamp() {
+		return table->timestamps[index];
+	}
+	bool getsuspect() {
+		return table->flags[index] & MemberTable::MEMBER_SUSPECT;
+	}
+	bool getunconfirmed() {
+		return table->flags[index] & MemberTable::MEMBER_UNCONFIRMED;
+	}
+	void setheartbeat(long heartbeat) {
+		table->setheartbeat(index, (int32_t)heartbeat);
+	}
+	// A later timestamp only pushes the deadlines back, timers already set
+	// fire early and are set again, see MemberTable::reschedule
+	void settimestamp(long timestamp) {
+		bool earlier = timestamp < table->timestamps[index];
+		table->timestamps[index] = (int32_t)timestamp;
+		if ( table->timed && (earlier || !table->armed(index)) ) {
+			table->reschedule(index);
+		}
+	}
+	void setsuspect(bool suspect) {
+		bool changed = suspect != getsuspect();
+		setflag(MemberTable::MEMBER_SUSPECT, suspect);
+		if ( table->timed && (changed || !table->armed(index)) ) {
+			table->reschedule(index);
+		}
+	}
+	void setunconfirmed(bool unconfirmed) {
+		setflag(MemberTable::MEMBER_UNCONFIRMED, unconfirmed);
+	}
+	operator MemberListEntry() {
+		MemberListEntry e(getid(), getport(), getheartbeat(), gettimestamp());
+		e.setsuspect(getsuspect());
+		e.setunconfirmed(getunconfirmed());
+		return e;
+	}
+};
+
+MemberRef MemberTable::operator [](int index) {
+	return MemberRef(this, index);
+}
+
+/**
+ * FUNCTION NAME: sample
+ *
+ * DESCRIPTION: Put up to k positions of live entries into out, picked at random
+ * 				among those accept(position) is true for. A partial Fisher-Yates
+ * 				shuffle of the live index: draws one number per entry looked at,
+ * 				k of them when every entry is accepted, and allocates nothing
+ * 				once out has room for k. Returns the number picked.
+ */
+template<class Accept, class Rng> int MemberTable::sample(int k, Accept accept, Rng &rng, vector<int> &out) {
+	out.clear();
+	int n = (int)live.size();
+	for ( int i = 0; i < n && (int)out.size() < k; i++ ) {
+		int j = i + rng() % (n - i);
+		swap(live[i], live[j]);
+		liveAt[live[i]] = i;
+		liveAt[live[j]] = j;
+		if ( accept(live[i]) ) {
+			out.push_back(live[i]);
+		}
+	}
+	return (int)out.size();
+}
+
 /**
  * CLASS NAME: Member
  *
@@ -105,15 +419,15 @@ public:
 	// counter for ping timeout
 	int timeOutCounter;
 	// Membership table
-	vector<MemberListEntry> memberList;
+	MemberTable memberList;
 	// My position in the membership table
-	vector<MemberListEntry>::iterator myPos;
-	// Queue for failure detection messages
-	queue<q_elt> mp1q;
+	int myPos;
+	// Messages delivered to this member, not copied with it
+	Inbox inbox;
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0), myPos(-1) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
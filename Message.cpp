@@ -0,0 +1,99 @@
+/**********************************
+ * FILE NAME: Message.cpp
+ *
+ * DESCRIPTION: Definition of the message encoder and decoder
+ **********************************/
+
+#include "Message.h"
+
+/**
+ * Constructor
+ */
+MessageWriter::MessageWriter(char *buff, int capacity, enum MsgTypes msgType): buff(buff), capacity(capacity), length(0), count(0) {
+	MessageHdr hdr;
+	hdr.msgType = msgType;
+	hdr.count = 0;
+	if ( capacity >= (int)sizeof(MessageHdr) ) {
+		memcpy(buff, &hdr, sizeof(MessageHdr));
+		length = sizeof(MessageHdr);
+	}
+}
+
+/**
+ * FUNCTION NAME: append
+ *
+ * DESCRIPTION: Append one entry and patch the count in the header.
+ * 				Returns false if the entry does not fit in the buffer.
+ */
+bool MessageWriter::append(int id, short port, long heartbeat) {
+	MemberEntryMsg e;
+
+	if ( length == 0 || length + (int)sizeof(MemberEntryMsg) > capacity ) {
+		return false;
+	}
+
+	e.id = id;
+	e.port = port;
+	e.heartbeat = (int32_t)heartbeat;
+	memcpy(buff + length, &e, sizeof(MemberEntryMsg));
+	length += sizeof(MemberEntryMsg);
+
+	++count;
+	memcpy(buff + offsetof(MessageHdr, count), &count, sizeof(int32_t));
+	return true;
+}
+
+/**
+ * FUNCTION NAME: append
+ *
+ * DESCRIPTION: Append a membership list entry
+ */
+bool MessageWriter::append(MemberListEntry &entry) {
+	return append(entry.getid(), entry.getport(), entry.getheartbeat());
+}
+
+/**
+ * FUNCTION NAME: append
+ *
+ * DESCRIPTION: Append an entry of a membership table
+ */
+bool MessageWriter::append(MemberRef entry) {
+	return append(entry.getid(), entry.getport(), entry.getheartbeat());
+}
+
+/**
+ * FUNCTION NAME: maxEntries
+ *
+ * DESCRIPTION: Number of entries that fit in a message of the given capacity
+ */
+int MessageWriter::maxEntries(int capacity) {
+	if ( capacity < (int)sizeof(MessageHdr) ) {
+		return 0;
+	}
+	return (capacity - (int)sizeof(MessageHdr)) / (int)sizeof(MemberEntryMsg);
+}
+
+/**
+ * Constructor
+ */
+MessageReader::MessageReader(const char *data, int size): data(data), length(size), ok(false) {
+	if ( size < (int)sizeof(MessageHdr) ) {
+		return;
+	}
+	memcpy(&hdr, data, sizeof(MessageHdr));
+	ok = hdr.count >= 0 && hdr.count <= MessageWriter::maxEntries(size);
+}
+
+/**
+ * FUNCTION NAME: entry
+ *
+ * DESCRIPTION: Decode the entry at index into out. The timestamp is left
+ * 				for the caller to set.
+ */
+void MessageReader::entry(int index, MemberListEntry &out) {
+	MemberEntryMsg e;
+	memcpy(&e, data + sizeof(MessageHdr) + index * sizeof(MemberEntryMsg), sizeof(MemberEntryMsg));
+	out.setid(e.id);
+	out.setport(e.port);
+	out.setheartbeat(e.heartbeat);
+}
@@ -0,0 +1,132 @@
+/**********************************
+ * FILE NAME: Message.h
+ *
+ * DESCRIPTION: Wire format of the membership protocol messages
+ **********************************/
+
+#ifndef _MESSAGE_H_
+#define _MESSAGE_H_
+
+#include "stdincludes.h"
+#include "Member.h"
+
+/**
+ * Message Types
+ */
+enum MsgTypes{
+    JOINREQ,
+    JOINREP,
+    GOSSIP,
+    PING,
+    ACK,
+    PINGREQ,
+    DIGEST,
+    DIGESTREP
+};
+
+/**
+ * STRUCT NAME: MessageHdr
+ *
+ * DESCRIPTION: Header of a message. It is followed on the wire by
+ * 				count packed MemberEntryMsg records.
+ */
+typedef struct MessageHdr {
+	enum MsgTypes msgType;
+	int32_t count;
+}MessageHdr;
+
+/*
+ * GOSSIP messages start with the entry of the sending node
+ */
+#define GOSSIP_SENDER 0
+
+/*
+ * SWIM messages (PING, ACK, PINGREQ) start with two fixed entries, followed
+ * by piggybacked membership updates:
+ * 	SWIM_SENDER	the sending node
+ * 	SWIM_ORIGIN	PING, ACK: the node that started the probe
+ * 				PINGREQ: the node to probe on behalf of the sender
+ * Both carry the sequence number of the probe in place of a heartbeat.
+ * In the updates, the heartbeat is the incarnation of an alive member,
+ * minus the incarnation of a suspected member, and 0 for a failed one.
+ */
+#define SWIM_SENDER 0
+#define SWIM_ORIGIN 1
+#define SWIM_HDR_ENTRIES 2
+
+/*
+ * DIGEST and DIGESTREP messages, the push-pull anti-entropy exchange, start with
+ * the entry of the sending node and a DIGEST_INFO entry whose id is the number of
+ * buckets. One entry per bucket follows: its id is the number of live members
+ * hashed to the bucket and its heartbeat the XOR of their hashes. A DIGESTREP
+ * then carries the entries of the buckets that differ. The last leg is a
+ * DIGESTREP with no buckets, which is not answered.
+ */
+#define DIGEST_INFO 1
+#define DIGEST_HDR_ENTRIES 2
+
+/**
+ * STRUCT NAME: MemberEntryMsg
+ *
+ * DESCRIPTION: Packed, fixed-layout membership entry as carried on the wire.
+ * 				Timestamps are local to each node and are not sent.
+ */
+#pragma pack(push, 1)
+typedef struct MemberEntryMsg {
+	int32_t id;
+	int16_t port;
+	int32_t heartbeat;
+}MemberEntryMsg;
+#pragma pack(pop)
+
+/**
+ * CLASS NAME: MessageWriter
+ *
+ * DESCRIPTION: Encodes a message into a caller owned buffer. Never allocates.
+ */
+class MessageWriter {
+private:
+	char *buff;
+	int capacity;
+	int length;
+	int count;
+public:
+	MessageWriter(char *buff, int capacity, enum MsgTypes msgType);
+	bool append(int id, short port, long heartbeat);
+	bool append(MemberListEntry &entry);
+	bool append(MemberRef entry);
+	int getcount() {
+		return count;
+	}
+	int size() {
+		return length;
+	}
+	static int maxEntries(int capacity);
+};
+
+/**
+ * CLASS NAME: MessageReader
+ *
+ * DESCRIPTION: Decodes a message in place. Never allocates.
+ */
+class MessageReader {
+private:
+	const char *data;
+	int length;
+	MessageHdr hdr;
+	bool ok;
+public:
+	MessageReader(const char *data, int size);
+	bool valid() {
+		return ok;
+	}
+	enum MsgTypes getType() {
+		return hdr.msgType;
+	}
+	int getcount() {
+		return hdr.count;
+	}
+	void entry(int index, MemberListEntry &out);
+};
+
+#endif /* _MESSAGE_H_ */
@@ -0,0 +1,89 @@
+/**********************************
+ * FILE NAME: MsgArena.cpp
+ *
+ * DESCRIPTION: Definition of the message slab allocator
+ **********************************/
+
+#include "MsgArena.h"
+
+/**
+ * Constructor
+ * Size classes go up to the first one holding maxBytes
+ */
+MsgArena::MsgArena(int maxBytes): slotsInUse(0) {
+	numClasses = 1;
+	while ( (ARENA_MIN_SLOT << (numClasses - 1)) < maxBytes ) {
+		numClasses++;
+	}
+	freeList.resize(numClasses);
+}
+
+/**
+ * Destructor
+ */
+MsgArena::~MsgArena() {
+	for ( int i = 0; i < (int)chunks.size(); i++ ) {
+		free(chunks[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: sizeClass
+ *
+ * DESCRIPTION: Smallest size class holding bytes, -1 if none does
+ */
+int MsgArena::sizeClass(int bytes) {
+	int cls = 0;
+	while ( cls < numClasses && (ARENA_MIN_SLOT << cls) < bytes ) {
+		cls++;
+	}
+	return cls < numClasses ? cls : -1;
+}
+
+/**
+ * FUNCTION NAME: refill
+ *
+ * DESCRIPTION: Carve a new chunk into free slots of class cls
+ */
+void MsgArena::refill(int cls) {
+	int slotBytes = ARENA_SLOT_HDR + (ARENA_MIN_SLOT << cls);
+	char *chunk = (char *)malloc((size_t)slotBytes * ARENA_SLOTS_PER_CHUNK);
+	chunks.push_back(chunk);
+	freeList[cls].reserve(freeList[cls].size() + ARENA_SLOTS_PER_CHUNK);
+	for ( int i = ARENA_SLOTS_PER_CHUNK - 1; i >= 0; i-- ) {
+		char *slot = chunk + (size_t)i * slotBytes;
+		*(int *)slot = cls;
+		freeList[cls].push_back(slot);
+	}
+}
+
+/**
+ * FUNCTION NAME: alloc
+ *
+ * DESCRIPTION: Get a slot holding at least bytes. Returns NULL if bytes is
+ * 				larger than the arena was built for.
+ */
+void *MsgArena::alloc(int bytes) {
+	int cls = sizeClass(bytes);
+	if ( cls < 0 ) {
+		return NULL;
+	}
+	if ( freeList[cls].empty() ) {
+		refill(cls);
+	}
+	char *slot = freeList[cls].back();
+	freeList[cls].pop_back();
+	slotsInUse++;
+	return slot + ARENA_SLOT_HDR;
+}
+
+/**
+ * FUNCTION NAME: release
+ *
+ * DESCRIPTION: Give a slot returned by alloc back to its free list
+ */
+void MsgArena::release(void *ptr) {
+	char *slot = (char *)ptr - ARENA_SLOT_HDR;
+	freeList[*(int *)slot].push_back(slot);
+	slotsInUse--;
+}
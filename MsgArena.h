@@ -0,0 +1,58 @@
+/**********************************
+ * FILE NAME: MsgArena.h
+ *
+ * DESCRIPTION: Size-class slab allocator for emulated network messages
+ **********************************/
+
+#ifndef _MSGARENA_H_
+#define _MSGARENA_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// Smallest slot size, each further size class doubles it
+#define ARENA_MIN_SLOT 64
+// Slots carved out of each chunk requested from the heap
+#define ARENA_SLOTS_PER_CHUNK 64
+// Bytes in front of every slot recording its size class
+#define ARENA_SLOT_HDR 16
+
+/**
+ * CLASS NAME: MsgArena
+ *
+ * DESCRIPTION: Hands out message slots from per size class free lists.
+ * 				Memory is requested from the heap in chunks and released slots
+ * 				are recycled, never freed, so a steady message rate does no heap
+ * 				allocation and memory use stays flat. A slot may be released to
+ * 				any arena built with the same maxBytes; it then belongs to that one.
+ * 				An arena is not thread safe, EmulNet keeps one per shard.
+ */
+class MsgArena {
+private:
+	int numClasses;
+	// Free slots of each size class
+	vector< vector<char *> > freeList;
+	// Every chunk ever allocated, freed with the arena
+	vector<char *> chunks;
+	long slotsInUse;
+	int sizeClass(int bytes);
+	void refill(int cls);
+public:
+	MsgArena(int maxBytes);
+	virtual ~MsgArena();
+	void *alloc(int bytes);
+	void release(void *ptr);
+	long getSlotsInUse() {
+		return slotsInUse;
+	}
+	long getChunks() {
+		return (long)chunks.size();
+	}
+private:
+	MsgArena(const MsgArena &anotherArena);
+	MsgArena& operator =(const MsgArena &anotherArena);
+};
+
+#endif /* _MSGARENA_H_ */
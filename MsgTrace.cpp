@@ -0,0 +1,110 @@
+/**********************************
+ * FILE NAME: MsgTrace.cpp
+ *
+ * DESCRIPTION: Definition of the message trace
+ **********************************/
+
+#include "MsgTrace.h"
+
+/**
+ * Constructor
+ */
+MsgTrace::MsgTrace(): fp(NULL), havePending(false) {
+	memset(&hdr, 0, sizeof(hdr));
+}
+
+/**
+ * Destructor
+ */
+MsgTrace::~MsgTrace() {
+	if ( fp != NULL ) {
+		fclose(fp);
+	}
+}
+
+/**
+ * FUNCTION NAME: openRecord
+ *
+ * DESCRIPTION: Start a new trace file for a run of nodes nodes seeded with seed
+ */
+bool MsgTrace::openRecord(const char *file, unsigned int seed, int nodes) {
+	fp = fopen(file, "wb");
+	if ( fp == NULL ) {
+		return false;
+	}
+	hdr.magic = MSGTRACE_MAGIC;
+	hdr.version = MSGTRACE_VERSION;
+	hdr.seed = seed;
+	hdr.nodes = nodes;
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: openReplay
+ *
+ * DESCRIPTION: Open a trace file to read back. Returns false if it is not one.
+ */
+bool MsgTrace::openReplay(const char *file) {
+	fp = fopen(file, "rb");
+	if ( fp == NULL ) {
+		return false;
+	}
+	if ( fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != MSGTRACE_MAGIC || hdr.version != MSGTRACE_VERSION ) {
+		fclose(fp);
+		fp = NULL;
+		return false;
+	}
+	havePending = readNext();
+	return true;
+}
+
+/**
+ * FUNCTION NAME: record
+ *
+ * DESCRIPTION: Append a message delivered at time
+ */
+void MsgTrace::record(int time, NodeId from, NodeId to, char *data, int size) {
+	MsgTraceRecord rec;
+	rec.time = time;
+	from.toBytes(rec.from);
+	to.toBytes(rec.to);
+	rec.size = size;
+	fwrite(&rec, sizeof(rec), 1, fp);
+	fwrite(data, 1, size, fp);
+}
+
+/**
+ * FUNCTION NAME: readNext
+ *
+ * DESCRIPTION: Read the next record and its payload. False at the end of the file.
+ */
+bool MsgTrace::readNext() {
+	if ( fread(&pending, sizeof(pending), 1, fp) != 1 || pending.size < 0 ) {
+		return false;
+	}
+	payload.resize(pending.size);
+	return pending.size == 0 || fread(&payload[0], 1, pending.size, fp) == (size_t)pending.size;
+}
+
+/**
+ * FUNCTION NAME: next
+ *
+ * DESCRIPTION: Hand out the next message delivered at time, data pointing at its
+ * 				payload until the following call. Messages of earlier ticks left
+ * 				over are skipped. Returns false once there is none left for time.
+ */
+bool MsgTrace::next(int time, MsgTraceRecord &rec, char *&data) {
+	while ( havePending && pending.time < time ) {
+		havePending = readNext();
+	}
+	if ( !havePending || pending.time != time ) {
+		return false;
+	}
+	rec = pending;
+	// Keep the payload handed out while the next record is read
+	current.swap(payload);
+	data = current.empty() ? NULL : &current[0];
+	havePending = readNext();
+	return true;
+}
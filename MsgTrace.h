@@ -0,0 +1,81 @@
+/**********************************
+ * FILE NAME: MsgTrace.h
+ *
+ * DESCRIPTION: Recorded trace of the messages delivered by the emulated network
+ **********************************/
+
+#ifndef _MSGTRACE_H_
+#define _MSGTRACE_H_
+
+#include "stdincludes.h"
+#include "Member.h"
+
+/*
+ * Macros
+ */
+#define MSGTRACE_MAGIC 0x4543524d
+#define MSGTRACE_VERSION 1
+
+/**
+ * STRUCT NAME: MsgTraceHdr
+ *
+ * DESCRIPTION: Start of a trace file, with the run it was recorded from
+ */
+typedef struct MsgTraceHdr {
+	int32_t magic;
+	int32_t version;
+	uint32_t seed;
+	int32_t nodes;
+}MsgTraceHdr;
+
+/**
+ * STRUCT NAME: MsgTraceRecord
+ *
+ * DESCRIPTION: One delivered message, followed in the file by its size bytes.
+ * 				Records are in delivery order, so in tick order.
+ */
+#pragma pack(push, 1)
+typedef struct MsgTraceRecord {
+	int32_t time;
+	char from[6];
+	char to[6];
+	int32_t size;
+}MsgTraceRecord;
+#pragma pack(pop)
+
+/**
+ * CLASS NAME: MsgTrace
+ *
+ * DESCRIPTION: Writes the messages a run delivers to a trace file, or reads them
+ * 				back tick by tick to deliver them again in a later run.
+ */
+class MsgTrace {
+private:
+	FILE *fp;
+	MsgTraceHdr hdr;
+	// Next record read and not handed out yet
+	MsgTraceRecord pending;
+	bool havePending;
+	// Payload of the pending record and of the last one handed out
+	vector<char> payload;
+	vector<char> current;
+	bool readNext();
+public:
+	MsgTrace();
+	virtual ~MsgTrace();
+	bool openRecord(const char *file, unsigned int seed, int nodes);
+	bool openReplay(const char *file);
+	void record(int time, NodeId from, NodeId to, char *data, int size);
+	bool next(int time, MsgTraceRecord &rec, char *&data);
+	unsigned int getSeed() {
+		return hdr.seed;
+	}
+	int getNodes() {
+		return hdr.nodes;
+	}
+private:
+	MsgTrace(const MsgTrace &anotherTrace);
+	MsgTrace& operator =(const MsgTrace &anotherTrace);
+};
+
+#endif /* _MSGTRACE_H_ */
@@ -29,16 +29,219 @@ void Params::setparams(char *config_file) {
 	EN_GPSZ = MAX_NNB;
 	STEP_RATE=.25;
 	MAX_MSG_SIZE = 4000;
+	GOSSIP_MODE = FULL_GOSSIP;
+	GOSSIP_MAX_ENTRIES = 0;
+	GOSSIP_RANDOM = 4;
+	GOSSIP_FANOUT = 0;
+	GOSSIP_INTERVAL = 0;
+	GOSSIP_INTERVAL_MAX = 5;
+	GOSSIP_NEAR_MISS = 15;
+	ANTI_ENTROPY = 0;
+	TARGETS = RANDOM_TARGETS;
+	ZONE_SIZE = 0;
+	DETECTOR = GOSSIP_DETECTOR;
+	SWIM_K = 3;
+	SUSPECT_TIMEOUT = 0;
+	TOMBSTONE_TTL = 100;
+	TIMEOUTS = SWEEP_TIMEOUTS;
+	THREADS = 1;
+	INBOX_SIZE = INBOX_DEFAULT_SIZE;
+	SCHEDULER = EVENT_SCHEDULER;
+	LATENCY = 0;
+	LATENCY_JITTER = 0;
+	LATENCY_DIST = UNIFORM_LATENCY;
+	LATENCY_SPREAD = 0;
+	BANDWIDTH = 0;
+	BANDWIDTH_QUEUE = 10;
+	LOSS_BURST_ENTER = 0;
+	LOSS_BURST_EXIT = 0.2;
+	LOSS_BURST_DROP = 0.5;
+	SEED = 0;
+	RUN_TIME = 0;
+	FAIL_TIME = 100;
+	CHURN_INTERVAL = 0;
+	PROFILE = "";
+	RECORD = "";
+	REPLAY = "";
+	LOG_FORMAT = TEXT_LOG;
+	VERBOSITY = TRACE_INFO;
 	globaltime = 0;
 	dropmsg = 0;
+
+	// Optional "KEY: value" lines after the required ones
+	char key[64], value[64];
+	while ( fscanf(fp, " %63[^:]: %63s", key, value) == 2 ) {
+		if ( !setparam(key, value) ) {
+			fprintf(stderr, "Unknown parameter %s in %s\n", key, config_file);
+		}
+	}
+
 	allNodesJoined = 0;
-	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
+	for ( int i = 0; i < EN_GPSZ; i++ ) {
 		allNodesJoined += i;
 	}
 	fclose(fp);
 	return;
 }
 
+/**
+ * FUNCTION NAME: setparam
+ *
+ * DESCRIPTION: Set one optional parameter from its name and value in the config file.
+ * 				Returns false if the name is not known.
+ */
+bool Params::setparam(const char *key, const char *value) {
+	if ( !strcmp(key, "GOSSIP_MODE") ) {
+		GOSSIP_MODE = strcmp(value, "delta") ? FULL_GOSSIP : DELTA_GOSSIP;
+	}
+	else if ( !strcmp(key, "DETECTOR") ) {
+		DETECTOR = strcmp(value, "swim") ? GOSSIP_DETECTOR : SWIM_DETECTOR;
+	}
+	else if ( !strcmp(key, "SUSPECT_TIMEOUT") ) {
+		SUSPECT_TIMEOUT = atoi(value);
+	}
+	else if ( !strcmp(key, "TOMBSTONE_TTL") ) {
+		TOMBSTONE_TTL = atoi(value);
+	}
+	else if ( !strcmp(key, "TIMEOUTS") ) {
+		TIMEOUTS = strcmp(value, "wheel") ? SWEEP_TIMEOUTS : WHEEL_TIMEOUTS;
+	}
+	else if ( !strcmp(key, "SWIM_K") ) {
+		SWIM_K = atoi(value);
+	}
+	else if ( !strcmp(key, "GOSSIP_MAX_ENTRIES") ) {
+		GOSSIP_MAX_ENTRIES = atoi(value);
+	}
+	else if ( !strcmp(key, "GOSSIP_RANDOM") ) {
+		GOSSIP_RANDOM = atoi(value);
+	}
+	else if ( !strcmp(key, "GOSSIP_FANOUT") ) {
+		GOSSIP_FANOUT = atoi(value);
+	}
+	else if ( !strcmp(key, "GOSSIP_INTERVAL") ) {
+		GOSSIP_INTERVAL = atoi(value);
+	}
+	else if ( !strcmp(key, "GOSSIP_INTERVAL_MAX") ) {
+		GOSSIP_INTERVAL_MAX = atoi(value);
+	}
+	else if ( !strcmp(key, "GOSSIP_NEAR_MISS") ) {
+		GOSSIP_NEAR_MISS = atoi(value);
+	}
+	else if ( !strcmp(key, "ANTI_ENTROPY") ) {
+		ANTI_ENTROPY = atoi(value);
+	}
+	else if ( !strcmp(key, "TARGETS") ) {
+		TARGETS = strcmp(value, "roundrobin") ? RANDOM_TARGETS : ROUND_ROBIN_TARGETS;
+	}
+	else if ( !strcmp(key, "ZONE_SIZE") ) {
+		ZONE_SIZE = atoi(value);
+	}
+	else if ( !strcmp(key, "THREADS") ) {
+		THREADS = atoi(value);
+	}
+	else if ( !strcmp(key, "INBOX_SIZE") ) {
+		INBOX_SIZE = max(1, atoi(value));
+	}
+	else if ( !strcmp(key, "SCHEDULER") ) {
+		SCHEDULER = strcmp(value, "tick") ? EVENT_SCHEDULER : TICK_SCHEDULER;
+	}
+	else if ( !strcmp(key, "LATENCY") ) {
+		LATENCY = max(0, atoi(value));
+	}
+	else if ( !strcmp(key, "LATENCY_JITTER") ) {
+		LATENCY_JITTER = max(0, atoi(value));
+	}
+	else if ( !strcmp(key, "LATENCY_DIST") ) {
+		LATENCY_DIST = strcmp(value, "exp") ? UNIFORM_LATENCY : EXP_LATENCY;
+	}
+	else if ( !strcmp(key, "LATENCY_SPREAD") ) {
+		LATENCY_SPREAD = max(0, atoi(value));
+	}
+	else if ( !strcmp(key, "BANDWIDTH") ) {
+		BANDWIDTH = max(0, atoi(value));
+	}
+	else if ( !strcmp(key, "BANDWIDTH_QUEUE") ) {
+		BANDWIDTH_QUEUE = max(0, atoi(value));
+	}
+	else if ( !strcmp(key, "LOSS_BURST_ENTER") ) {
+		LOSS_BURST_ENTER = atof(value);
+	}
+	else if ( !strcmp(key, "LOSS_BURST_EXIT") ) {
+		LOSS_BURST_EXIT = atof(value);
+	}
+	else if ( !strcmp(key, "LOSS_BURST_DROP") ) {
+		LOSS_BURST_DROP = atof(value);
+	}
+	else if ( !strcmp(key, "PARTITION") ) {
+		Partition p;
+		if ( sscanf(value, "%d-%d:%d-%d", &p.start, &p.end, &p.lo, &p.hi) != 4 ) {
+			return false;
+		}
+		PARTITIONS.push_back(p);
+	}
+	else if ( !strcmp(key, "SEED") ) {
+		SEED = (unsigned int)strtoul(value, NULL, 10);
+	}
+	else if ( !strcmp(key, "LOG_FORMAT") ) {
+		if ( !strcmp(value, "binary") ) {
+			LOG_FORMAT = BINARY_LOG;
+		}
+		else if ( !strcmp(value, "none") ) {
+			LOG_FORMAT = NO_LOG;
+		}
+		else {
+			LOG_FORMAT = TEXT_LOG;
+		}
+	}
+	else if ( !strcmp(key, "VERBOSITY") ) {
+		VERBOSITY = atoi(value);
+	}
+	else if ( !strcmp(key, "RUN_TIME") ) {
+		RUN_TIME = atoi(value);
+	}
+	else if ( !strcmp(key, "FAIL_TIME") ) {
+		FAIL_TIME = atoi(value);
+	}
+	else if ( !strcmp(key, "CHURN_INTERVAL") ) {
+		CHURN_INTERVAL = atoi(value);
+	}
+	else if ( !strcmp(key, "STEP_RATE") ) {
+		STEP_RATE = atof(value);
+	}
+	else if ( !strcmp(key, "PROFILE") ) {
+		PROFILE = value;
+	}
+	else if ( !strcmp(key, "MAX_MSG_SIZE") ) {
+		MAX_MSG_SIZE = atoi(value);
+	}
+	else if ( !strcmp(key, "RECORD") ) {
+		RECORD = value;
+	}
+	else if ( !strcmp(key, "REPLAY") ) {
+		REPLAY = value;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: setarg
+ *
+ * DESCRIPTION: Set one optional parameter from a KEY=value command line argument,
+ * 				which takes precedence over the config file. Returns false if the
+ * 				argument is malformed or the name is not known.
+ */
+bool Params::setarg(const char *arg) {
+	const char *eq = strchr(arg, '=');
+	if ( eq == NULL || eq == arg ) {
+		return false;
+	}
+	string key(arg, eq - arg);
+	return setparam(key.c_str(), eq + 1);
+}
+
 /**
  * FUNCTION NAME: getcurrtime
  *
@@ -48,3 +251,30 @@ void Params::setparams(char *config_file) {
 int Params::getcurrtime(){
     return globaltime;
 }
+
+/**
+ * FUNCTION NAME: zoneCount
+ *
+ * DESCRIPTION: Number of zones of the hierarchical mode, 0 when the group is flat.
+ * 				Zones are only used with the gossip detector.
+ */
+int Params::zoneCount() {
+	if ( ZONE_SIZE <= 0 || DETECTOR != GOSSIP_DETECTOR ) {
+		return 0;
+	}
+	return (EN_GPSZ + ZONE_SIZE - 1) / ZONE_SIZE;
+}
+
+/**
+ * FUNCTION NAME: zoneOf
+ *
+ * DESCRIPTION: Zone of the node with this id. Ids are grouped in ranges of ZONE_SIZE;
+ * 				ids handed out past EN_GPSZ, to nodes replaced by churn, wrap around.
+ */
+int Params::zoneOf(int id) {
+	int zones = zoneCount();
+	if ( zones == 0 ) {
+		return 0;
+	}
+	return ((id - 1) / ZONE_SIZE) % zones;
+}
@@ -10,8 +10,29 @@
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "Trace.h"
 
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
+enum gossipMODE { FULL_GOSSIP, DELTA_GOSSIP };
+enum detectorMODE { GOSSIP_DETECTOR, SWIM_DETECTOR };
+enum logFORMAT { TEXT_LOG, BINARY_LOG, NO_LOG };
+enum schedulerMODE { TICK_SCHEDULER, EVENT_SCHEDULER };
+enum latencyDIST { UNIFORM_LATENCY, EXP_LATENCY };
+enum targetMODE { RANDOM_TARGETS, ROUND_ROBIN_TARGETS };
+enum timeoutMODE { SWEEP_TIMEOUTS, WHEEL_TIMEOUTS };
+
+/**
+ * STRUCT NAME: Partition
+ *
+ * DESCRIPTION: Scheduled network partition: from tick start until tick end, the
+ * 				nodes with ids lo to hi can only reach each other
+ */
+typedef struct Partition {
+	int start;
+	int end;
+	int lo;
+	int hi;
+}Partition;
 
 /**
  * CLASS NAME: Params
@@ -29,11 +50,52 @@ public:
 	int DROP_MSG;
 	int dropmsg;
 	int globaltime;
-	int allNodesJoined;
+	long allNodesJoined;
 	short PORTNUM;
+	int GOSSIP_MODE;            // full membership list or only entries changed since the last exchange
+	int GOSSIP_MAX_ENTRIES;     // changed entries carried by each delta gossip, 0 for as many as fit
+	int DETECTOR;               // heartbeat gossip or SWIM probing
+	int SUSPECT_TIMEOUT;        // ticks a member stays suspected before it is removed, 0 for the detector's default
+	int TOMBSTONE_TTL;          // ticks a removed member is remembered before it leaves the list
+	int TIMEOUTS;               // gossip detector timeouts found by a sweep of the list, or by a timer wheel per member
+	int SWIM_K;                 // members asked to probe indirectly when a SWIM probe is not acked
+	int GOSSIP_RANDOM;          // unchanged entries piggybacked on each delta gossip
+	int GOSSIP_FANOUT;          // members gossiped to each round, 0 to adapt it to the group size and loss
+	int GOSSIP_INTERVAL;        // ticks between gossip rounds, 0 to adapt it to how fresh the list is
+	int GOSSIP_INTERVAL_MAX;    // longest adaptive gossip interval
+	int GOSSIP_NEAR_MISS;       // ticks between heartbeats of a member that make the adaptive interval shorter
+	int ANTI_ENTROPY;           // gossip rounds between push-pull digest exchanges with a random member, 0 for none
+	int TARGETS;                // gossip targets and SWIM probes picked at random, or in turn from a shuffled order
+	int ZONE_SIZE;              // ids per zone of the hierarchical gossip mode, 0 for one flat group
+	int THREADS;                // threads the simulation is run on
+	int INBOX_SIZE;             // messages a node's inbox holds, more wait in the network until it is drained
+	int SCHEDULER;              // run every node every tick, or only the nodes with messages or a timer due
+	int LATENCY;                // ticks a message spends in the network on top of the one to the next tick
+	int LATENCY_JITTER;         // extra ticks of latency drawn per message, up to this
+	int LATENCY_DIST;           // jitter uniform, or exponential with a mean of a quarter of LATENCY_JITTER
+	int LATENCY_SPREAD;         // extra ticks of latency of each pair of nodes, fixed per pair, up to this
+	int BANDWIDTH;              // bytes a node can send per tick, 0 for no limit
+	int BANDWIDTH_QUEUE;        // ticks a message may wait for the link of its sender before it is dropped
+	double LOSS_BURST_ENTER;    // chance a message sent over a good link turns it bad, 0 for no bursts
+	double LOSS_BURST_EXIT;     // chance a message sent over a bad link turns it good again
+	double LOSS_BURST_DROP;     // share of the messages lost while the link is bad
+	vector<Partition> PARTITIONS; // one for each "PARTITION: start-end:lo-hi" line
+	unsigned int SEED;          // random seed, 0 to seed from the clock
+	int LOG_FORMAT;             // dbg.log as text, binary events in dbg.bin, or no log
+	int VERBOSITY;              // highest trace level printed, see Trace.h
+	int RUN_TIME;               // ticks to simulate, 0 for the default run length
+	int FAIL_TIME;              // tick the nodes fail at
+	int CHURN_INTERVAL;         // once all have joined, replace a random node by a new one this often, 0 for no churn
+	string PROFILE;             // file run statistics are written to as JSON, empty for none
+	string RECORD;              // file the delivered messages are recorded to, empty for none
+	string REPLAY;              // recorded messages delivered in place of the ones sent, empty to run normally
 	Params();
 	void setparams(char *);
+	bool setparam(const char *key, const char *value);
+	bool setarg(const char *arg);
 	int getcurrtime();
+	int zoneCount();
+	int zoneOf(int id);
 };
 
 #endif /* _PARAMS_H_ */
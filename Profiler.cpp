@@ -0,0 +1,117 @@
+/**********************************
+ * FILE NAME: Profiler.cpp
+ *
+ * DESCRIPTION: Definition of the run statistics collector
+ **********************************/
+
+#include "Profiler.h"
+
+/**
+ * Constructor
+ */
+Profiler::Profiler(): enabled(false) {}
+
+/**
+ * FUNCTION NAME: get
+ *
+ * DESCRIPTION: The profiler of this process
+ */
+Profiler &Profiler::get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+/**
+ * FUNCTION NAME: enable
+ *
+ * DESCRIPTION: Start collecting, with one set of counters per simulation thread
+ */
+void Profiler::enable(int threads) {
+	ShardProfile zero;
+	memset(&zero, 0, sizeof(zero));
+	shards.assign(threads < 1 ? 1 : threads, zero);
+	enabled = true;
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Count sec seconds spent in phase by the calling shard
+ */
+void Profiler::add(int phase, double sec) {
+	ShardProfile &s = shards[TickExecutor::currentShard()];
+	s.phaseSec[phase] += sec;
+	s.phaseCalls[phase]++;
+}
+
+/**
+ * FUNCTION NAME: nodeFailed
+ *
+ * DESCRIPTION: Record that node id failed at time. Called between simulation phases.
+ */
+void Profiler::nodeFailed(int id, int time) {
+	if ( !enabled ) {
+		return;
+	}
+	if ( id >= (int)failedAt.size() ) {
+		failedAt.resize(id + 1, -1);
+	}
+	failedAt[id] = time;
+}
+
+/**
+ * FUNCTION NAME: nodeRemoved
+ *
+ * DESCRIPTION: Record that some node removed node id from its list at time
+ */
+void Profiler::nodeRemoved(int id, int time) {
+	if ( !enabled ) {
+		return;
+	}
+	ShardProfile &s = shards[TickExecutor::currentShard()];
+	if ( id < (int)failedAt.size() && failedAt[id] >= 0 ) {
+		int latency = time - failedAt[id];
+		s.detections++;
+		s.latencySum += latency;
+		if ( latency > s.latencyMax ) {
+			s.latencyMax = latency;
+		}
+	}
+	else {
+		s.falseRemovals++;
+	}
+}
+
+/**
+ * FUNCTION NAME: getFailed
+ *
+ * DESCRIPTION: Number of nodes failed so far
+ */
+int Profiler::getFailed() {
+	int failed = 0;
+	for ( int i = 0; i < (int)failedAt.size(); i++ ) {
+		if ( failedAt[i] >= 0 ) {
+			failed++;
+		}
+	}
+	return failed;
+}
+
+/**
+ * FUNCTION NAME: total
+ *
+ * DESCRIPTION: Add up the counters of all shards into sum
+ */
+void Profiler::total(ShardProfile &sum) {
+	memset(&sum, 0, sizeof(sum));
+	for ( int i = 0; i < (int)shards.size(); i++ ) {
+		for ( int p = 0; p < PHASE_COUNT; p++ ) {
+			sum.phaseSec[p] += shards[i].phaseSec[p];
+			sum.phaseCalls[p] += shards[i].phaseCalls[p];
+		}
+		sum.detections += shards[i].detections;
+		sum.latencySum += shards[i].latencySum;
+		sum.latencyMax = max(sum.latencyMax, shards[i].latencyMax);
+		sum.falseRemovals += shards[i].falseRemovals;
+	}
+}
@@ -0,0 +1,93 @@
+/**********************************
+ * FILE NAME: Profiler.h
+ *
+ * DESCRIPTION: Run statistics for benchmarking: time spent in each simulation
+ * 				phase and how fast failures are detected
+ **********************************/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include "stdincludes.h"
+#include "TickExecutor.h"
+#include <chrono>
+
+/**
+ * Phases timed by the profiler
+ */
+enum ProfilePhase {
+	PHASE_RECV_LOOP,
+	PHASE_CHECK_MESSAGES,
+	PHASE_NODE_LOOP_OPS,
+	PHASE_EN_SEND,
+	PHASE_COUNT
+};
+
+/**
+ * STRUCT NAME: ShardProfile
+ *
+ * DESCRIPTION: Counters of one shard, so threads never share them
+ */
+typedef struct ShardProfile {
+	double phaseSec[PHASE_COUNT];
+	long phaseCalls[PHASE_COUNT];
+	// Removals of failed nodes and their latency in ticks
+	long detections;
+	long latencySum;
+	int latencyMax;
+	// Removals of nodes that never failed
+	long falseRemovals;
+	// Pad to a cache line of its own
+	char pad[64];
+}ShardProfile;
+
+/**
+ * CLASS NAME: Profiler
+ *
+ * DESCRIPTION: Collects the statistics of one run when enabled, does nothing otherwise.
+ * 				The Application fills it in and writes it out as JSON.
+ */
+class Profiler {
+private:
+	bool enabled;
+	vector<ShardProfile> shards;
+	// Tick each node id failed at, -1 while it is up
+	vector<int> failedAt;
+	Profiler();
+public:
+	static Profiler &get();
+	bool isEnabled() {
+		return enabled;
+	}
+	void enable(int threads);
+	void add(int phase, double sec);
+	void nodeFailed(int id, int time);
+	void nodeRemoved(int id, int time);
+	int getFailed();
+	void total(ShardProfile &sum);
+};
+
+/**
+ * CLASS NAME: ProfileScope
+ *
+ * DESCRIPTION: Times the enclosing scope into a phase when profiling is enabled
+ */
+class ProfileScope {
+private:
+	int phase;
+	bool on;
+	chrono::steady_clock::time_point start;
+public:
+	ProfileScope(int phase): phase(phase), on(Profiler::get().isEnabled()) {
+		if ( on ) {
+			start = chrono::steady_clock::now();
+		}
+	}
+	~ProfileScope() {
+		if ( on ) {
+			Profiler::get().add(phase, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+		}
+	}
+};
+
+#endif /* _PROFILER_H_ */
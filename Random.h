@@ -0,0 +1,72 @@
+/**********************************
+ * FILE NAME: Random.h
+ *
+ * DESCRIPTION: Seeded random number generator of the simulator
+ **********************************/
+
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include "stdincludes.h"
+
+/**
+ * Random number streams, one per simulator component. Node n draws from
+ * RNG_STREAM_NODE + n, so what one component draws never shifts the numbers
+ * of another, whatever order they run in.
+ */
+enum rngSTREAM {
+	RNG_STREAM_NET,
+	RNG_STREAM_FAIL,
+	RNG_STREAM_NODE
+};
+
+/**
+ * CLASS NAME: Random
+ *
+ * DESCRIPTION: PCG32 generator. Each seed and stream pair gives its own
+ * 				sequence, the state is 16 bytes and a draw is a multiply and a
+ * 				few shifts. Meets the uniform random bit generator requirements,
+ * 				so it can drive shuffle.
+ */
+class Random {
+private:
+	uint64_t state;
+	uint64_t inc;
+public:
+	typedef uint32_t result_type;
+	Random(uint64_t seed = 0, uint64_t stream = 0) {
+		this->seed(seed, stream);
+	}
+	// PCG sequences that only differ in the increment are correlated, so the
+	// seed and the stream are both hashed into the state and the increment
+	void seed(uint64_t seed, uint64_t stream) {
+		uint64_t key = mix(seed ^ mix(stream));
+		state = 0;
+		inc = (mix(key) << 1) | 1;
+		(*this)();
+		state += key;
+		(*this)();
+	}
+	result_type operator()() {
+		uint64_t old = state;
+		state = old * 6364136223846793005ULL + inc;
+		uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+		uint32_t rot = (uint32_t)(old >> 59);
+		return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+	}
+	static constexpr result_type min() {
+		return 0;
+	}
+	static constexpr result_type max() {
+		return UINT32_MAX;
+	}
+	// splitmix64 finalizer
+	static uint64_t mix(uint64_t z) {
+		z += 0x9e3779b97f4a7c15ULL;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+};
+
+#endif /* _RANDOM_H_ */
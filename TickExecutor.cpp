@@ -0,0 +1,102 @@
+/**********************************
+ * FILE NAME: TickExecutor.cpp
+ *
+ * DESCRIPTION: Definition of the simulation worker pool
+ **********************************/
+
+#include "TickExecutor.h"
+
+// Shard the calling thread is working on, 0 outside of a worker
+static thread_local int shardOfThread = 0;
+
+/**
+ * Constructor
+ */
+TickExecutor::TickExecutor(int threads): threads(threads < 1 ? 1 : threads), generation(0), pending(0), stopping(false), job(NULL), jobSize(0) {
+	for ( int i = 1; i < this->threads; i++ ) {
+		workers.push_back(thread(&TickExecutor::workerLoop, this, i));
+	}
+}
+
+/**
+ * Destructor
+ */
+TickExecutor::~TickExecutor() {
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for ( int i = 0; i < (int)workers.size(); i++ ) {
+		workers[i].join();
+	}
+}
+
+/**
+ * FUNCTION NAME: currentShard
+ *
+ * DESCRIPTION: Shard of the calling thread
+ */
+int TickExecutor::currentShard() {
+	return shardOfThread;
+}
+
+/**
+ * FUNCTION NAME: runShard
+ *
+ * DESCRIPTION: Run the current job on one shard
+ */
+void TickExecutor::runShard(int shard) {
+	int begin = (int)((long)jobSize * shard / threads);
+	int end = (int)((long)jobSize * (shard + 1) / threads);
+	(*job)(shard, begin, end);
+}
+
+/**
+ * FUNCTION NAME: workerLoop
+ *
+ * DESCRIPTION: Wait for each new phase, run this worker's shard and report back
+ */
+void TickExecutor::workerLoop(int shard) {
+	long seen = 0;
+	shardOfThread = shard;
+	while ( true ) {
+		{
+			unique_lock<mutex> guard(lock);
+			wake.wait(guard, [&] { return stopping || generation != seen; });
+			if ( stopping ) {
+				return;
+			}
+			seen = generation;
+		}
+		runShard(shard);
+		{
+			lock_guard<mutex> guard(lock);
+			if ( --pending == 0 ) {
+				done.notify_one();
+			}
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Run fn(shard, begin, end) on every shard of [0, n) and wait for all of them
+ */
+void TickExecutor::run(int n, const function<void(int shard, int begin, int end)> &fn) {
+	job = &fn;
+	jobSize = n;
+	if ( threads > 1 ) {
+		lock_guard<mutex> guard(lock);
+		pending = threads - 1;
+		generation++;
+	}
+	wake.notify_all();
+	runShard(0);
+	if ( threads > 1 ) {
+		unique_lock<mutex> guard(lock);
+		done.wait(guard, [&] { return pending == 0; });
+	}
+	job = NULL;
+}
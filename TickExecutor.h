@@ -0,0 +1,52 @@
+/**********************************
+ * FILE NAME: TickExecutor.h
+ *
+ * DESCRIPTION: Worker pool that runs one simulation phase over all nodes in parallel
+ **********************************/
+
+#ifndef _TICKEXECUTOR_H_
+#define _TICKEXECUTOR_H_
+
+#include "stdincludes.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * CLASS NAME: TickExecutor
+ *
+ * DESCRIPTION: Splits [0, n) into one contiguous shard per thread and runs a job
+ * 				on every shard. run() returns once all shards are done, which is
+ * 				the barrier between simulation phases. Shard 0 runs on the
+ * 				calling thread, so a single thread executor runs inline.
+ */
+class TickExecutor {
+private:
+	int threads;
+	vector<thread> workers;
+	mutex lock;
+	condition_variable wake;
+	condition_variable done;
+	long generation;
+	int pending;
+	bool stopping;
+	// Job of the current phase, valid while run() is in progress
+	const function<void(int, int, int)> *job;
+	int jobSize;
+	void workerLoop(int shard);
+	void runShard(int shard);
+public:
+	TickExecutor(int threads);
+	virtual ~TickExecutor();
+	void run(int n, const function<void(int shard, int begin, int end)> &fn);
+	int getThreads() {
+		return threads;
+	}
+	static int currentShard();
+private:
+	TickExecutor(const TickExecutor &anotherExecutor);
+	TickExecutor& operator =(const TickExecutor &anotherExecutor);
+};
+
+#endif /* _TICKEXECUTOR_H_ */
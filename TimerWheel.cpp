@@ -0,0 +1,301 @@
+/**********************************
+ * FILE NAME: TimerWheel.cpp
+ *
+ * DESCRIPTION: Definition of the hierarchical timing wheel
+ **********************************/
+
+#include "TimerWheel.h"
+
+/**
+ * Constructor
+ */
+TimerWheel::TimerWheel(): now(0), count(0) {
+	clear();
+}
+
+/**
+ * FUNCTION NAME: resize
+ *
+ * DESCRIPTION: Make room for the keys 0 to keys - 1. Keys past the new size must
+ * 				not be scheduled.
+ */
+void TimerWheel::resize(int keys) {
+	due.resize(keys, 0);
+	next.resize(keys, -1);
+	prev.resize(keys, -1);
+	where.resize(keys, -1);
+}
+
+/**
+ * FUNCTION NAME: slotFor
+ *
+ * DESCRIPTION: Slot of a deadline: the lowest level whose block above holds both
+ * 				now and the deadline, so every timer of a level is due before those
+ * 				of the levels above. The top level takes the rest.
+ */
+int TimerWheel::slotFor(int tick) {
+	// The highest bit tick and now differ in tells the level
+	uint32_t differ = (uint32_t)(tick ^ now) >> WHEEL_BITS;
+	int level = differ == 0 ? 0 : min(WHEEL_LEVELS - 1, (31 - __builtin_clz(differ)) / WHEEL_BITS + 1);
+	return level * WHEEL_SLOTS + ((tick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+}
+
+/**
+ * FUNCTION NAME: place
+ *
+ * DESCRIPTION: Link key into the slot of its deadline
+ */
+void TimerWheel::place(int key) {
+	int index = slotFor(due[key]);
+	next[key] = head[index];
+	prev[key] = -1;
+	if ( head[index] != -1 ) {
+		prev[head[index]] = key;
+	}
+	head[index] = key;
+	where[key] = (int16_t)index;
+	used[index / WHEEL_SLOTS] |= 1ULL << (index % WHEEL_SLOTS);
+}
+
+/**
+ * FUNCTION NAME: unlink
+ *
+ * DESCRIPTION: Take key out of its slot
+ */
+void TimerWheel::unlink(int key) {
+	int index = where[key];
+	if ( prev[key] != -1 ) {
+		next[prev[key]] = next[key];
+	}
+	else {
+		head[index] = next[key];
+	}
+	if ( next[key] != -1 ) {
+		prev[next[key]] = prev[key];
+	}
+	if ( head[index] == -1 ) {
+		used[index / WHEEL_SLOTS] &= ~(1ULL << (index % WHEEL_SLOTS));
+	}
+	where[key] = -1;
+}
+
+/**
+ * FUNCTION NAME: detach
+ *
+ * DESCRIPTION: Empty slot index, returning its first key; the rest follow through next
+ */
+int TimerWheel::detach(int index) {
+	int first = head[index];
+	for ( int key = first; key != -1; key = next[key] ) {
+		where[key] = -1;
+	}
+	head[index] = -1;
+	used[index / WHEEL_SLOTS] &= ~(1ULL << (index % WHEEL_SLOTS));
+	return first;
+}
+
+/**
+ * FUNCTION NAME: schedule
+ *
+ * DESCRIPTION: Set the timer of key to fire at tick, replacing the one it had. A tick
+ * 				that has passed fires at the next advance.
+ */
+void TimerWheel::schedule(int key, int tick) {
+	if ( where[key] != -1 ) {
+		unlink(key);
+		count--;
+	}
+	due[key] = max(tick, now + 1);
+	place(key);
+	count++;
+}
+
+/**
+ * FUNCTION NAME: cancel
+ *
+ * DESCRIPTION: Stop the timer of key, if it has one
+ */
+void TimerWheel::cancel(int key) {
+	if ( where[key] != -1 ) {
+		unlink(key);
+		count--;
+	}
+}
+
+/**
+ * FUNCTION NAME: move
+ *
+ * DESCRIPTION: Give the timer of key from to key to, which loses its own. For tables
+ * 				that move an entry into the place of an erased one.
+ */
+void TimerWheel::move(int from, int to) {
+	cancel(to);
+	if ( where[from] == -1 ) {
+		return;
+	}
+	int index = where[from];
+	due[to] = due[from];
+	next[to] = next[from];
+	prev[to] = prev[from];
+	where[to] = (int16_t)index;
+	if ( prev[to] != -1 ) {
+		next[prev[to]] = to;
+	}
+	else {
+		head[index] = to;
+	}
+	if ( next[to] != -1 ) {
+		prev[next[to]] = to;
+	}
+	where[from] = -1;
+}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Stop every timer
+ */
+void TimerWheel::clear() {
+	for ( int index = 0; index < WHEEL_LEVELS * WHEEL_SLOTS; index++ ) {
+		head[index] = -1;
+	}
+	for ( int level = 0; level < WHEEL_LEVELS; level++ ) {
+		used[level] = 0;
+	}
+	fill(where.begin(), where.end(), -1);
+	count = 0;
+}
+
+/**
+ * FUNCTION NAME: reached
+ *
+ * DESCRIPTION: Bitmap of the slots of level whose first tick is tick or before
+ */
+uint64_t TimerWheel::reached(int level, int tick) {
+	int span = WHEEL_BITS * (level + 1);
+	if ( (tick >> span) != (now >> span) ) {
+		return ~0ULL;
+	}
+	int last = (tick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+	return last == WHEEL_SLOTS - 1 ? ~0ULL : (2ULL << last) - 1;
+}
+
+/**
+ * FUNCTION NAME: advance
+ *
+ * DESCRIPTION: Move the time on to tick and append the keys whose timers fired, in no
+ * 				particular order, to fired. Only the slots that tick has reached are
+ * 				looked at: their timers either fire or go down to a lower level.
+ * 				Returns the number fired.
+ */
+int TimerWheel::advance(int tick, vector<int> &fired) {
+	if ( tick <= now ) {
+		return 0;
+	}
+	int before = (int)fired.size();
+
+	// A level 0 slot is a single tick, all its timers fire
+	uint64_t bits = used[0] & reached(0, tick);
+	while ( bits ) {
+		int index = __builtin_ctzll(bits);
+		bits &= bits - 1;
+		for ( int key = detach(index); key != -1; key = next[key] ) {
+			fired.push_back(key);
+			count--;
+		}
+	}
+
+	// Detach the slots above that tick has reached, chaining them through next.
+	// Their timers are placed again once now is tick, the timers left in other
+	// slots are placed right for it.
+	int moving = -1;
+	for ( int level = 1; level < WHEEL_LEVELS; level++ ) {
+		bits = used[level] & reached(level, tick);
+		while ( bits ) {
+			int index = level * WHEEL_SLOTS + __builtin_ctzll(bits);
+			bits &= bits - 1;
+			int key = detach(index);
+			while ( key != -1 ) {
+				int after = next[key];
+				next[key] = moving;
+				moving = key;
+				key = after;
+			}
+		}
+	}
+
+	now = tick;
+	while ( moving != -1 ) {
+		int key = moving;
+		moving = next[key];
+		if ( due[key] <= tick ) {
+			fired.push_back(key);
+			count--;
+		}
+		else {
+			place(key);
+		}
+	}
+	return (int)fired.size() - before;
+}
+
+/**
+ * FUNCTION NAME: nextDue
+ *
+ * DESCRIPTION: Earliest deadline of the timers, INT_MAX if none is set
+ */
+int TimerWheel::nextDue() {
+	if ( count == 0 ) {
+		return INT_MAX;
+	}
+	int level = 0;
+	while ( used[level] == 0 ) {
+		level++;
+	}
+	// A level 0 slot is a single tick
+	if ( level == 0 ) {
+		return (now & ~(WHEEL_SLOTS - 1)) + __builtin_ctzll(used[0]);
+	}
+	// Above, the lowest slot holds the earliest timers; deadlines past the
+	// top level wrap around it, so there every slot is looked at
+	int earliest = INT_MAX;
+	uint64_t bits = level == WHEEL_LEVELS - 1 ? used[level] : used[level] & -used[level];
+	while ( bits ) {
+		int index = level * WHEEL_SLOTS + __builtin_ctzll(bits);
+		bits &= bits - 1;
+		for ( int key = head[index]; key != -1; key = next[key] ) {
+			earliest = min(earliest, (int)due[key]);
+		}
+	}
+	return earliest;
+}
+
+/**
+ * FUNCTION NAME: earliest
+ *
+ * DESCRIPTION: Earliest deadline of the timers, INT_MAX if none is set, and the
+ * 				keys whose timers fire then into keys
+ */
+int TimerWheel::earliest(vector<int> &keys) {
+	keys.clear();
+	int tick = nextDue();
+	if ( tick == INT_MAX ) {
+		return tick;
+	}
+	for ( int key = head[slotFor(tick)]; key != -1; key = next[key] ) {
+		if ( due[key] == tick ) {
+			keys.push_back(key);
+		}
+	}
+	return tick;
+}
+
+/**
+ * FUNCTION NAME: memoryBytes
+ *
+ * DESCRIPTION: Bytes allocated for the timers
+ */
+long TimerWheel::memoryBytes() {
+	return (long)(sizeof(head) + sizeof(used) + (due.capacity() + next.capacity() + prev.capacity()) * sizeof(int32_t)
+				  + where.capacity() * sizeof(int16_t));
+}
@@ -0,0 +1,74 @@
+/**********************************
+ * FILE NAME: TimerWheel.h
+ *
+ * DESCRIPTION: Hierarchical timing wheel
+ **********************************/
+
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// Slots per level are 1 << WHEEL_BITS, a level covers 1 << WHEEL_BITS times the ticks of the one below
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+
+/**
+ * CLASS NAME: TimerWheel
+ *
+ * DESCRIPTION: One timer per key, keys being small integers such as the
+ * 				positions of a table. Level 0 has a slot per tick of the
+ * 				current 64 tick block, level 1 a slot per 64 ticks of the
+ * 				current 4096, and so on; deadlines past the top level wrap
+ * 				around it. Each slot is a list threaded through per key
+ * 				arrays, and each level keeps a bitmap of the slots in use,
+ * 				so scheduling and cancelling are O(1), advancing costs the
+ * 				timers that fire or move down a level plus a few bit scans,
+ * 				and nothing is allocated past the per key arrays.
+ */
+class TimerWheel {
+private:
+	// Every deadline up to now has fired
+	int now;
+	// Per key: deadline, neighbours in its slot, and its slot, -1 if not scheduled
+	vector<int32_t> due;
+	vector<int32_t> next;
+	vector<int32_t> prev;
+	vector<int16_t> where;
+	// First key of each slot, -1 if empty, and the slots in use per level
+	int32_t head[WHEEL_LEVELS * WHEEL_SLOTS];
+	uint64_t used[WHEEL_LEVELS];
+	int count;
+	int slotFor(int tick);
+	void place(int key);
+	void unlink(int key);
+	int detach(int index);
+	uint64_t reached(int level, int tick);
+public:
+	TimerWheel();
+	void resize(int keys);
+	void schedule(int key, int tick);
+	void cancel(int key);
+	void move(int from, int to);
+	void clear();
+	int advance(int tick, vector<int> &fired);
+	int nextDue();
+	int earliest(vector<int> &keys);
+	bool scheduled(int key) {
+		return key < (int)where.size() && where[key] != -1;
+	}
+	// Tick the timer of key fires at, if scheduled
+	int deadline(int key) {
+		return due[key];
+	}
+	int size() {
+		return count;
+	}
+	long memoryBytes();
+};
+
+#endif /* _TIMERWHEEL_H_ */
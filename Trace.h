@@ -0,0 +1,61 @@
+/**********************************
+ * FILE NAME: Trace.h
+ *
+ * DESCRIPTION: Leveled console tracing. Levels above TRACE_LEVEL are compiled
+ * 				out, the rest are switched on at runtime by VERBOSITY.
+ **********************************/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+/*
+ * Trace levels
+ */
+#define TRACE_OFF 0
+// Progress of the run, such as nodes being introduced
+#define TRACE_INFO 1
+// Membership changes seen by each node
+#define TRACE_EVENT 2
+// Every message handled and sent
+#define TRACE_MSG 3
+
+// Highest level built in, e.g. -DTRACE_LEVEL=3 to trace messages
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_INFO
+#endif
+
+/**
+ * FUNCTION NAME: traceVerbosity
+ *
+ * DESCRIPTION: Highest level traced at runtime, set from VERBOSITY in the conf file
+ */
+inline int &traceVerbosity() {
+	static int verbosity = TRACE_INFO;
+	return verbosity;
+}
+
+#define TRACEAT(level, ...) do { if ( traceVerbosity() >= (level) ) { __VA_ARGS__; } } while (0)
+
+/*
+ * Run the statements given when tracing at that level.
+ * A level that is not built in leaves nothing behind, not even the arguments.
+ */
+#if TRACE_LEVEL >= TRACE_INFO
+#define TRACEINFO(...) TRACEAT(TRACE_INFO, __VA_ARGS__)
+#else
+#define TRACEINFO(...) do { } while (0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_EVENT
+#define TRACEEVENT(...) TRACEAT(TRACE_EVENT, __VA_ARGS__)
+#else
+#define TRACEEVENT(...) do { } while (0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_MSG
+#define TRACEMSG(...) TRACEAT(TRACE_MSG, __VA_ARGS__)
+#else
+#define TRACEMSG(...) do { } while (0)
+#endif
+
+#endif /* _TRACE_H_ */
@@ -0,0 +1,154 @@
+/**********************************
+ * FILE NAME: EmulNetBench.cpp
+ *
+ * DESCRIPTION: Time one simulated tick of EmulNet traffic: every node sends
+ * 				FANOUT messages, then every node receives. Compares receiving
+ * 				from per-destination mailboxes with the old single buffer scan,
+ * 				and sending one copy per target with one shared ENsendv payload.
+ **********************************/
+
+#include "../EmulNet.h"
+#include <chrono>
+
+#define FANOUT 4
+#define MSG_BYTES 200
+#define TICKS 50
+
+/**
+ * CLASS NAME: LinearNet
+ *
+ * DESCRIPTION: The global buffer EmulNet used before mailboxes, where every
+ * 				receive scans all buffered messages
+ */
+class LinearNet {
+public:
+	vector<en_msg*> buff;
+	void send(Address *from, Address *to, char *data, int size) {
+		en_msg *em = (en_msg *)malloc(sizeof(en_msg) + size);
+		em->size = size;
+		em->from = from->nodeId();
+		em->to = to->nodeId();
+		memcpy(em + 1, data, size);
+		buff.push_back(em);
+	}
+	void recv(Address *me, int (* enq)(void *, char *, int), void *queue) {
+		for ( int i = (int)buff.size() - 1; i >= 0; i-- ) {
+			en_msg *emsg = buff[i];
+			if ( emsg->to == me->nodeId() ) {
+				char *tmp = (char *)malloc(emsg->size);
+				memcpy(tmp, (char *)(emsg + 1), emsg->size);
+				buff[i] = buff.back();
+				buff.pop_back();
+				(*enq)(queue, tmp, emsg->size);
+				free(emsg);
+			}
+		}
+	}
+};
+
+/**
+ * STRUCT NAME: sink
+ */
+typedef struct sink {
+	EmulNet *en;
+	long delivered;
+}sink;
+
+/**
+ * FUNCTION NAME: consume
+ *
+ * DESCRIPTION: Receive callback that counts and releases the message
+ */
+static int consume(void *env, char *buff, int size) {
+	((sink *)env)->delivered++;
+	((sink *)env)->en->ENrelease(buff);
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: consumeLinear
+ *
+ * DESCRIPTION: Receive callback for LinearNet, which copies into malloc'd memory
+ */
+static int consumeLinear(void *env, char *buff, int size) {
+	(*(long *)env)++;
+	free(buff);
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	int sizes[] = { 10, 100, 1000 };
+	char payload[MSG_BYTES];
+	memset(payload, 7, sizeof(payload));
+
+	printf("%8s %12s %12s %16s %12s %12s %12s\n", "nodes", "send_us", "sendv_us", "recv_us", "linear_recv_us", "delivered", "envelopes");
+
+	for ( int s = 0; s < (int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+		int n = sizes[s];
+		Params par;
+		par.EN_GPSZ = n;
+		par.MAX_MSG_SIZE = 4000;
+		par.MSG_DROP_PROB = 0;
+		par.dropmsg = 0;
+		par.globaltime = 0;
+		par.SEED = 1;
+
+		EmulNet *en = new EmulNet(&par);
+		vector<Address> addrs(n);
+		for ( int i = 0; i < n; i++ ) {
+			en->ENinit(&addrs[i], par.PORTNUM);
+		}
+		LinearNet linear;
+
+		srand(1);
+		sink delivered = { en, 0 };
+		long linearDelivered = 0;
+		double sendUs = 0, sendvUs = 0, recvUs = 0, linearUs = 0;
+		Address targets[FANOUT];
+		for ( int tick = 0; tick < TICKS; tick++ ) {
+			par.globaltime = tick;
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for ( int i = 0; i < n; i++ ) {
+				for ( int k = 0; k < FANOUT; k++ ) {
+					en->ENsend(&addrs[i], &addrs[rand() % n], payload, sizeof(payload));
+				}
+			}
+			en->ENflush();
+			chrono::steady_clock::time_point sent = chrono::steady_clock::now();
+			for ( int i = 0; i < n; i++ ) {
+				en->ENrecv(&addrs[i], consume, NULL, 1, &delivered);
+			}
+			sendUs += chrono::duration<double, micro>(sent - start).count();
+			recvUs += chrono::duration<double, micro>(chrono::steady_clock::now() - sent).count();
+
+			start = chrono::steady_clock::now();
+			for ( int i = 0; i < n; i++ ) {
+				for ( int k = 0; k < FANOUT; k++ ) {
+					targets[k] = addrs[rand() % n];
+				}
+				en->ENsendv(&addrs[i], targets, FANOUT, payload, sizeof(payload));
+			}
+			en->ENflush();
+			sendvUs += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+			for ( int i = 0; i < n; i++ ) {
+				en->ENrecv(&addrs[i], consume, NULL, 1, &delivered);
+			}
+
+			for ( int i = 0; i < n; i++ ) {
+				for ( int k = 0; k < FANOUT; k++ ) {
+					linear.send(&addrs[i], &addrs[rand() % n], payload, sizeof(payload));
+				}
+			}
+			start = chrono::steady_clock::now();
+			for ( int i = 0; i < n; i++ ) {
+				linear.recv(&addrs[i], consumeLinear, &linearDelivered);
+			}
+			linearUs += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+		}
+
+		printf("%8d %12.1f %12.1f %12.1f %16.1f %12ld %12ld\n", n, sendUs / TICKS, sendvUs / TICKS, recvUs / TICKS, linearUs / TICKS, delivered.delivered, en->getEnvelopesTotal());
+		delete en;
+	}
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+/**********************************
+ * FILE NAME: InboxBench.cpp
+ *
+ * DESCRIPTION: Compares handing messages to a node through the std::queue of
+ * 				element and size it used to have with the lock-free Inbox:
+ * 				time per message of a tick's worth of pushes then takes, from
+ * 				one thread, pushing one at a time and the whole burst at once
+ * 				as EmulNet does. Then several producer threads push into one
+ * 				inbox while the consumer drains it in batches; checks every
+ * 				message arrives once and in the order its producer pushed it,
+ * 				and reports the messages per second.
+ **********************************/
+
+#include "../Inbox.h"
+#include <chrono>
+#include <thread>
+
+#define MESSAGES 20000000
+#define BATCH 32
+
+/**
+ * CLASS NAME: q_elt
+ *
+ * DESCRIPTION: Entry of the queue a node had before the inbox
+ */
+class q_elt {
+public:
+	void *elt;
+	int size;
+	q_elt(void *elt, int size): elt(elt), size(size) {}
+};
+
+/**
+ * FUNCTION NAME: elapsedNs
+ */
+static double elapsedNs(chrono::steady_clock::time_point start, long count) {
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+}
+
+/**
+ * FUNCTION NAME: produce
+ *
+ * DESCRIPTION: Push count messages tagged with the producer and a sequence
+ * 				number, retrying while the inbox is full
+ */
+static void produce(Inbox *inbox, int producer, int count) {
+	for ( int seq = 0; seq < count; seq++ ) {
+		while ( !inbox->push((char *)(long)seq, producer) ) {
+			this_thread::yield();
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int bursts[] = { 8, 64, 256 };
+	int producers[] = { 1, 2, 4 };
+	volatile long sink = 0;
+	bool ok = true;
+	static char payload[64];
+
+	printf("%8s %12s %12s %12s\n", "burst", "queue_ns", "inbox_ns", "batch_ns");
+	for ( int b = 0; b < (int)(sizeof(bursts)/sizeof(bursts[0])); b++ ) {
+		int burst = bursts[b];
+		int rounds = MESSAGES / burst;
+
+		queue<q_elt> q;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for ( int r = 0; r < rounds; r++ ) {
+			for ( int i = 0; i < burst; i++ ) {
+				q.emplace(q_elt(payload + (i & 63), i));
+			}
+			while ( !q.empty() ) {
+				sink += q.front().size;
+				q.pop();
+			}
+		}
+		double queueNs = elapsedNs(start, (long)rounds * burst);
+
+		Inbox inbox(burst);
+		InboxMsg batch[BATCH];
+		start = chrono::steady_clock::now();
+		for ( int r = 0; r < rounds; r++ ) {
+			for ( int i = 0; i < burst; i++ ) {
+				inbox.push(payload + (i & 63), i);
+			}
+			for ( int n = inbox.drain(batch, BATCH); n > 0; n = inbox.drain(batch, BATCH) ) {
+				for ( int k = 0; k < n; k++ ) {
+					sink += batch[k].size;
+				}
+			}
+		}
+		double inboxNs = elapsedNs(start, (long)rounds * burst);
+
+		vector<InboxMsg> msgs(burst);
+		for ( int i = 0; i < burst; i++ ) {
+			msgs[i].data = payload + (i & 63);
+			msgs[i].size = i;
+		}
+		start = chrono::steady_clock::now();
+		for ( int r = 0; r < rounds; r++ ) {
+			inbox.push(&msgs[0], burst);
+			for ( int n = inbox.drain(batch, BATCH); n > 0; n = inbox.drain(batch, BATCH) ) {
+				for ( int k = 0; k < n; k++ ) {
+					sink += batch[k].size;
+				}
+			}
+		}
+		double batchNs = elapsedNs(start, (long)rounds * burst);
+		printf("%8d %12.2f %12.2f %12.2f\n", burst, queueNs, inboxNs, batchNs);
+	}
+
+	printf("\n%9s %12s %12s\n", "producers", "capacity", "msgs_per_sec");
+	for ( int p = 0; p < (int)(sizeof(producers)/sizeof(producers[0])); p++ ) {
+		int threads = producers[p];
+		int count = MESSAGES / 4 / threads;
+		Inbox inbox(INBOX_DEFAULT_SIZE);
+		vector<int> next(threads, 0);
+		InboxMsg batch[BATCH];
+		long taken = 0;
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		vector<thread> pool;
+		for ( int t = 0; t < threads; t++ ) {
+			pool.push_back(thread(produce, &inbox, t, count));
+		}
+		while ( taken < (long)count * threads ) {
+			int n = inbox.drain(batch, BATCH);
+			if ( n == 0 ) {
+				this_thread::yield();
+			}
+			for ( int k = 0; k < n; k++ ) {
+				int producer = batch[k].size;
+				if ( (long)batch[k].data != next[producer] ) {
+					ok = false;
+				}
+				next[producer]++;
+			}
+			taken += n;
+		}
+		for ( int t = 0; t < threads; t++ ) {
+			pool[t].join();
+		}
+		double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		if ( !ok || !inbox.empty() ) {
+			printf("%9d messages lost or out of order\n", threads);
+			ok = false;
+			continue;
+		}
+		printf("%9d %12d %12.0f\n", threads, inbox.capacity(), taken / sec);
+	}
+
+	return ok ? 0 : 1;
+}
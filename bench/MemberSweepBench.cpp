@@ -0,0 +1,229 @@
+/**********************************
+ * FILE NAME: MemberSweepBench.cpp
+ *
+ * DESCRIPTION: Compares the per tick timeout check over a membership list
+ * 				stored as an array of MemberListEntry, as it was before, with
+ * 				the sweep of the columnar MemberTable, scalar and SIMD.
+ * 				Checks the three find the same entries and reports the time
+ * 				per entry for the gossip check and the SWIM one. Then runs a
+ * 				table through ticks of heartbeats and timeouts, once swept every
+ * 				tick and once with the timers of MemberTable::expire, checks
+ * 				both end up the same and reports the time per tick of the
+ * 				timeout check of each.
+ **********************************/
+
+#include "../Member.h"
+#include "../Random.h"
+#include <chrono>
+
+/**
+ * FUNCTION NAME: sweepEntries
+ *
+ * DESCRIPTION: MemberTable::sweep over an array of entries
+ */
+static int sweepEntries(vector<MemberListEntry> &list, int now, int liveAge, int deadAge, bool suspectsOnly,
+						vector<int> &expired, SweepResult &res) {
+	expired.clear();
+	res.live = 0;
+	res.oldestWatched = INT32_MAX;
+	res.oldestDead = INT32_MAX;
+	res.lowestFresh = INT32_MAX;
+	for ( int i = 0; i < (int)list.size(); i++ ) {
+		MemberListEntry &mle = list[i];
+		long age = now - mle.gettimestamp();
+		if ( mle.getheartbeat() == 0 ) {
+			if ( age > deadAge ) {
+				expired.push_back(i);
+			}
+			else {
+				res.oldestDead = min(res.oldestDead, (int32_t)mle.gettimestamp());
+			}
+			continue;
+		}
+		res.live++;
+		if ( suspectsOnly && !mle.getsuspect() ) {
+			continue;
+		}
+		if ( age > liveAge ) {
+			expired.push_back(i);
+			continue;
+		}
+		res.oldestWatched = min(res.oldestWatched, (int32_t)mle.gettimestamp());
+		if ( !mle.getsuspect() ) {
+			res.lowestFresh = min(res.lowestFresh, (int32_t)mle.getid());
+		}
+	}
+	return (int)expired.size();
+}
+
+/**
+ * FUNCTION NAME: same
+ */
+static bool same(vector<int> &a, SweepResult &ra, vector<int> &b, SweepResult &rb) {
+	return a == b && ra.live == rb.live && ra.oldestWatched == rb.oldestWatched
+		   && ra.oldestDead == rb.oldestDead && ra.lowestFresh == rb.lowestFresh;
+}
+
+/**
+ * FUNCTION NAME: elapsedNs
+ */
+static double elapsedNs(chrono::steady_clock::time_point start, long count) {
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / count;
+}
+
+/**
+ * FUNCTION NAME: runTicks
+ *
+ * DESCRIPTION: ticks ticks over table from tick start, handling timeouts the way
+ * 				the gossip detector does. Every member is heard from every other
+ * 				tick but one in a hundred, which stop; found by sweep or by expire,
+ * 				those are suspected past suspectAge, turned into tombstones past
+ * 				failAge, and past deadAge they come back. Returns the entries found,
+ * 				and the time per tick of the timeout check in checkNs.
+ */
+static long runTicks(MemberTable &table, bool timers, int start, int ticks, int suspectAge, int failAge, int deadAge,
+					 vector<int> &found, double &checkNs) {
+	long total = 0;
+	SweepResult res;
+	chrono::steady_clock::duration checking(0);
+	for ( int now = start; now < start + ticks; now++ ) {
+		for ( int i = now & 1; i < table.size(); i += 2 ) {
+			MemberRef mle = table[i];
+			if ( i % 100 != 0 && mle.getheartbeat() != 0 ) {
+				mle.setheartbeat(mle.getheartbeat() + 1);
+				mle.settimestamp(now);
+				mle.setsuspect(false);
+			}
+		}
+		chrono::steady_clock::time_point check = chrono::steady_clock::now();
+		if ( timers ) {
+			table.expire(now, found);
+		}
+		else {
+			table.sweep(now, suspectAge, deadAge, false, found, res);
+		}
+		for ( int k = 0; k < (int)found.size(); k++ ) {
+			MemberRef mle = table[found[k]];
+			if ( mle.getheartbeat() == 0 ) {
+				mle.setheartbeat(1);
+				mle.settimestamp(now);
+			}
+			else if ( now - mle.gettimestamp() > failAge ) {
+				mle.setheartbeat(0);
+				mle.setsuspect(false);
+				mle.settimestamp(now);
+			}
+			else {
+				mle.setsuspect(true);
+			}
+		}
+		checking += chrono::steady_clock::now() - check;
+		total += found.size();
+	}
+	checkNs = chrono::duration<double, nano>(checking).count() / ticks;
+	return total;
+}
+
+int main(int argc, char *argv[]) {
+	int sizes[] = { 100, 1000, 10000, 100000 };
+	int now = 1000;
+	int tfail = 5;
+	int ttl = 40;
+	volatile long sink = 0;
+	bool ok = true;
+
+	printf("%8s %6s %9s %12s %12s %12s %9s\n", "entries", "check", "expired", "aos_ns", "soa_ns", "simd_ns", "speedup");
+
+	for ( int s = 0; s < (int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+		int n = sizes[s];
+		// Mostly fresh members, a few suspects and old ones, and some tombstones
+		Random rng(425, n);
+		vector<MemberListEntry> list;
+		MemberTable table;
+		for ( int i = 1; i <= n; i++ ) {
+			int r = rng() % 100;
+			MemberListEntry e(i, 0, r < 3 ? 0 : 100 + i, now - (r < 6 ? (int)(rng() % 60) : (int)(rng() % 4)));
+			e.setsuspect(r >= 3 && r < 5);
+			list.push_back(e);
+			table.insert(e);
+		}
+		int iterations = max(20, 20000000 / n);
+
+		for ( int c = 0; c < 2; c++ ) {
+			bool suspectsOnly = c == 1;
+			vector<int> expired[3];
+			SweepResult res[3];
+
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for ( int it = 0; it < iterations; it++ ) {
+				sink += sweepEntries(list, now, tfail, ttl, suspectsOnly, expired[0], res[0]);
+			}
+			double aos = elapsedNs(start, (long)iterations * n);
+
+			start = chrono::steady_clock::now();
+			for ( int it = 0; it < iterations; it++ ) {
+				sink += table.sweepScalar(now, tfail, ttl, suspectsOnly, expired[1], res[1]);
+			}
+			double soa = elapsedNs(start, (long)iterations * n);
+
+			double simd = soa;
+#ifdef MEMBER_SIMD_SWEEP
+			start = chrono::steady_clock::now();
+			for ( int it = 0; it < iterations; it++ ) {
+				sink += table.sweepSimd(now, tfail, ttl, suspectsOnly, expired[2], res[2]);
+			}
+			simd = elapsedNs(start, (long)iterations * n);
+#else
+			table.sweepScalar(now, tfail, ttl, suspectsOnly, expired[2], res[2]);
+#endif
+
+			if ( !same(expired[0], res[0], expired[1], res[1]) || !same(expired[0], res[0], expired[2], res[2]) ) {
+				printf("%8d %6s results differ\n", n, suspectsOnly ? "swim" : "gossip");
+				ok = false;
+				continue;
+			}
+			printf("%8d %6s %9d %12.3f %12.3f %12.3f %8.1fx\n", n, suspectsOnly ? "swim" : "gossip",
+				   (int)expired[0].size(), aos, soa, simd, aos / simd);
+		}
+	}
+#ifndef MEMBER_SIMD_SWEEP
+	printf("built without MEMBER_SIMD_SWEEP, simd_ns is the scalar sweep\n");
+#endif
+
+	// The timeouts of the gossip detector, then ten times as long
+	printf("\n%8s %6s %12s %12s %12s %12s\n", "entries", "tfail", "sweep_found", "timer_found", "sweep_ns", "timer_ns");
+	for ( int scale = 1; scale <= 10; scale *= 10 ) {
+		int suspectAge = tfail * scale;
+		int failAge = 4 * tfail * scale;
+		int deadAge = ttl * scale;
+		for ( int s = 0; s < (int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+			int n = sizes[s];
+			int ticks = max(200, 20000000 / n);
+			MemberTable swept;
+			MemberTable timed;
+			timed.setTimeouts(suspectAge, failAge, deadAge);
+			for ( int i = 1; i <= n; i++ ) {
+				MemberListEntry e(i, 0, 100 + i, now);
+				swept.insert(e);
+				timed.insert(e);
+			}
+			vector<int> found;
+			double sweepNs, timerNs;
+			long sweptFound = runTicks(swept, false, now, ticks, suspectAge, failAge, deadAge, found, sweepNs);
+			long timedFound = runTicks(timed, true, now, ticks, suspectAge, failAge, deadAge, found, timerNs);
+			sink += sweptFound + timedFound;
+			for ( int i = 0; i < n; i++ ) {
+				if ( swept[i].getheartbeat() != timed[i].getheartbeat() || swept[i].gettimestamp() != timed[i].gettimestamp()
+					 || swept[i].getsuspect() != timed[i].getsuspect() ) {
+					printf("%8d %6d tables differ\n", n, suspectAge);
+					ok = false;
+					break;
+				}
+			}
+			printf("%8d %6d %12.1f %12.1f %12.1f %12.1f\n", n, suspectAge, (double)sweptFound / ticks,
+				   (double)timedFound / ticks, sweepNs, timerNs);
+		}
+	}
+
+	return ok ? 0 : 1;
+}
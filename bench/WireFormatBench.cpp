@@ -0,0 +1,135 @@
+/**********************************
+ * FILE NAME: WireFormatBench.cpp
+ *
+ * DESCRIPTION: Compares the comma separated text encoding of GOSSIP messages
+ * 				with the packed binary encoding in Message.h.
+ * 				Reports bytes on the wire and encode/decode time per message.
+ **********************************/
+
+#include "../Message.h"
+#include <chrono>
+#include <sstream>
+
+/**
+ * FUNCTION NAME: split
+ *
+ * DESCRIPTION: The stringstream splitter the text format was parsed with
+ */
+static void split(const string &s, char delim, vector<string> &elems) {
+	stringstream ss;
+	ss.str(s);
+	string item;
+	while (getline(ss, item, delim)) {
+		elems.push_back(item);
+	}
+}
+
+/**
+ * FUNCTION NAME: textEncode
+ *
+ * DESCRIPTION: "2,id:port:hb:ts,..." as built by nodeLoopOps before the binary format
+ */
+static string textEncode(vector<MemberListEntry> &list) {
+	string msg = to_string(2);
+	for (int i = 0; i < (int)list.size(); i++) {
+		msg = msg + "," + to_string(list[i].getid()) + ":" +
+		      to_string(list[i].getport()) + ":" +
+		      to_string(list[i].getheartbeat()) + ":" +
+		      to_string(list[i].gettimestamp());
+	}
+	return msg;
+}
+
+/**
+ * FUNCTION NAME: textDecode
+ *
+ * DESCRIPTION: Parse a text GOSSIP message as recvCallBack did
+ */
+static long textDecode(const char *data, vector<MemberListEntry> &out) {
+	string callBackData(data);
+	vector<string> dataVec;
+	split(callBackData, ',', dataVec);
+	long sum = stoi(dataVec[0]);
+	vector<string> tempMle;
+	for (int i = 0; i < (int)dataVec.size()-1; i++) {
+		split(dataVec[i+1], ':', tempMle);
+		out.push_back(MemberListEntry(stoi(tempMle[0]), (short)stoi(tempMle[1]), stol(tempMle[2]), stol(tempMle[3])));
+		sum += out.back().getheartbeat();
+		tempMle.clear();
+	}
+	return sum;
+}
+
+/**
+ * FUNCTION NAME: elapsedNs
+ */
+static double elapsedNs(chrono::steady_clock::time_point start, int iterations) {
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char *argv[]) {
+	int sizes[] = { 10, 100, 1000 };
+	int iterations = 2000;
+	volatile long sink = 0;
+
+	printf("%8s %12s %12s %14s %14s %14s %14s\n", "entries", "text_bytes", "bin_bytes",
+	       "text_enc_ns", "bin_enc_ns", "text_dec_ns", "bin_dec_ns");
+
+	for ( int s = 0; s < (int)(sizeof(sizes)/sizeof(sizes[0])); s++ ) {
+		int n = sizes[s];
+		vector<MemberListEntry> list;
+		for ( int i = 1; i <= n; i++ ) {
+			list.push_back(MemberListEntry(i, 0, 1000 + i * 7, 600 + i % 50));
+		}
+
+		int binCapacity = sizeof(MessageHdr) + n * sizeof(MemberEntryMsg);
+		char *bin = new char[binCapacity];
+		vector<MemberListEntry> decoded;
+		decoded.reserve(n);
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		string text;
+		for ( int it = 0; it < iterations; it++ ) {
+			text = textEncode(list);
+			sink += text.size();
+		}
+		double textEnc = elapsedNs(start, iterations);
+
+		start = chrono::steady_clock::now();
+		int binBytes = 0;
+		for ( int it = 0; it < iterations; it++ ) {
+			MessageWriter writer(bin, binCapacity, GOSSIP);
+			for ( int i = 0; i < n; i++ ) {
+				writer.append(list[i]);
+			}
+			binBytes = writer.size();
+			sink += binBytes;
+		}
+		double binEnc = elapsedNs(start, iterations);
+
+		start = chrono::steady_clock::now();
+		for ( int it = 0; it < iterations; it++ ) {
+			decoded.clear();
+			sink += textDecode(text.c_str(), decoded);
+		}
+		double textDec = elapsedNs(start, iterations);
+
+		start = chrono::steady_clock::now();
+		MemberListEntry mle;
+		for ( int it = 0; it < iterations; it++ ) {
+			MessageReader reader(bin, binBytes);
+			for ( int i = 0; i < reader.getcount(); i++ ) {
+				reader.entry(i, mle);
+				sink += mle.getheartbeat();
+			}
+		}
+		double binDec = elapsedNs(start, iterations);
+
+		// +1 for the terminating 0 the text format was sent with
+		printf("%8d %12d %12d %14.0f %14.0f %14.0f %14.0f\n", n, (int)text.size() + 1, binBytes,
+		       textEnc, binEnc, textDec, binDec);
+		delete[] bin;
+	}
+
+	return 0;
+}
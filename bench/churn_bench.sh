@@ -0,0 +1,70 @@
+#!/bin/bash
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/churn_bench.sh
+#* About this file: Long churn benchmark. Runs the same group with a node replaced
+#* every CHURN_INTERVAL ticks for longer and longer runs. Failed members are
+#* compacted out of the membership lists, so the list length, the table memory
+#* per node and the largest message must stay flat as the run grows.
+#* The statistics of every run are collected into one JSON array.
+#*
+#* Usage: bench/churn_bench.sh [Application] [output.json]
+#* Environment: NODES (default 100), CHURN (default 5), TIMES (default
+#*              "1000 2000 4000 8000"), SEED (default 425), THREADS (default 1),
+#*              EXTRA (conf lines added to every run, e.g. "DETECTOR: swim")
+#*
+#***********************
+
+APP=$(realpath "${1:-./Application}")
+OUT=${2:-churn.json}
+NODES=${NODES:-100}
+CHURN=${CHURN:-5}
+TIMES=${TIMES:-"1000 2000 4000 8000"}
+SEED=${SEED:-425}
+THREADS=${THREADS:-1}
+EXTRA=${EXTRA:-}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ ! -x "$APP" ]; then
+	echo "No Application at $APP" >&2
+	exit 1
+fi
+
+printf "%8s %8s %10s %14s %14s %12s %14s\n" "ticks" "churned" "entries_max" "table_B/node" "max_msg_B" "peak_rss_kb" "false_removals"
+first=1
+echo "[" > "$WORK/all.json"
+for t in $TIMES
+do
+	name="churn_n${NODES}_t${t}"
+	conf="$WORK/$name.conf"
+	# No scheduled failures, only churn
+	printf "MAX_NNB: %d\nSINGLE_FAILURE: 1\nDROP_MSG: 0\nMSG_DROP_PROB: 0\n" $NODES > "$conf"
+	printf "RUN_TIME: %d\nFAIL_TIME: -1\nCHURN_INTERVAL: %d\nSEED: %d\nTHREADS: %d\n" $t $CHURN $SEED $THREADS >> "$conf"
+	printf "LOG_FORMAT: none\nVERBOSITY: 0\nPROFILE: %s\n" "$WORK/$name.json" >> "$conf"
+	[ -z "$EXTRA" ] || printf "%b\n" "$EXTRA" >> "$conf"
+
+	if ! (cd "$WORK" && "$APP" "$conf" > /dev/null); then
+		echo "$name failed" >&2
+		continue
+	fi
+
+	awk -v nodes=$NODES -F'[:,]' '
+		/"ticks"/ { ticks = $2 }
+		/"failed_nodes"/ { churned = $2 }
+		/"member_entries_max"/ { entries = $2 }
+		/"member_table_bytes"/ { table = $2 }
+		/"max_msg_bytes"/ { msg = $2 }
+		/"peak_rss_kb"/ { rss = $2 }
+		/"false_removals"/ { fr = $2 }
+		END { printf "%8d %8d %10d %14d %14d %12d %14d\n", ticks, churned, entries, table / nodes, msg, rss, fr }' "$WORK/$name.json"
+
+	[ $first -eq 1 ] || echo "," >> "$WORK/all.json"
+	first=0
+	sed -e '1s/^{/{\n  "scenario": "'$name'",/' "$WORK/$name.json" >> "$WORK/all.json"
+done
+echo "]" >> "$WORK/all.json"
+cp "$WORK/all.json" "$OUT"
+echo "wrote $OUT" >&2
@@ -0,0 +1,90 @@
+#!/bin/bash
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/gossip_policy.sh
+#* About this file: Gossip policy report. Runs the sim_bench scenarios once per
+#* gossip policy and prints, for each scenario, the messages sent, the failures
+#* detected and the false removals of every policy next to the traffic change
+#* against the first one. The policies compared are the old fixed fanout 4 and
+#* interval 5, a fixed policy large enough to stay accurate at 100 nodes, the
+#* adaptive one, and the adaptive one taking its targets round robin. The
+#* adaptive policy and round robin then run once more in a larger group under
+#* drops, where members keep joining until tick 50 and must be gossiped to
+#* as soon as they join. The statistics of every run are collected into one
+#* JSON array.
+#*
+#* Usage: bench/gossip_policy.sh [Application] [output.json]
+#* Environment: SIZES (default "10 100"), LATE_SIZE (default 200),
+#*              RUN_TIME, SEED, THREADS as for sim_bench.sh
+#*
+#***********************
+
+APP=$(realpath "${1:-./Application}")
+OUT=${2:-gossip.json}
+SIZES=${SIZES:-"10 100"}
+LATE_SIZE=${LATE_SIZE:-200}
+BENCH=$(dirname "$0")/sim_bench.sh
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+NAMES=(fixed_4_5 fixed_6_4 adaptive roundrobin)
+POLICIES=("GOSSIP_FANOUT: 4\nGOSSIP_INTERVAL: 5" "GOSSIP_FANOUT: 6\nGOSSIP_INTERVAL: 4" "" "TARGETS: roundrobin")
+LATE_NAMES=(late_adaptive late_roundrobin)
+LATE_POLICIES=("" "TARGETS: roundrobin")
+
+for i in ${!NAMES[@]}
+do
+	echo "policy ${NAMES[$i]}" >&2
+	SIZES="$SIZES" EXTRA="${POLICIES[$i]}" "$BENCH" "$APP" "$WORK/${NAMES[$i]}.json" 2> /dev/null || exit 1
+done
+for i in ${!LATE_NAMES[@]}
+do
+	echo "policy ${LATE_NAMES[$i]}" >&2
+	SIZES="$LATE_SIZE" DROPS=0.1 EXTRA="${LATE_POLICIES[$i]}" "$BENCH" "$APP" "$WORK/${LATE_NAMES[$i]}.json" 2> /dev/null || exit 1
+done
+
+# Table of the given policies: one line per scenario, with the traffic of each
+# policy relative to the first
+report() {
+	printf "%-22s" "scenario"
+	for name in "$@"
+	do
+		printf " | %-15s %8s %9s %6s" "$name" "msgs" "detected" "false"
+	done
+	printf "\n"
+	awk -F'[:,]' '
+		FNR == 1 { policy++ }
+		/"scenario"/ { gsub(/[ "]/, "", $2); scen = $2; if (policy == 1) order[++n] = scen }
+		/"msgs_sent"/ { msgs[policy, scen] = $2 }
+		/"detections"/ { det[policy, scen] = $2 }
+		/"detections_expected"/ { expected[policy, scen] = $2 }
+		/"false_removals"/ { fr[policy, scen] = $2 }
+		END {
+			for (i = 1; i <= n; i++) {
+				s = order[i]
+				printf "%-22s", s
+				for (p = 1; p <= policy; p++) {
+					printf " | %+14.1f%% %8d %4d/%-4d %6d", 100.0 * (msgs[p, s] - msgs[1, s]) / msgs[1, s], msgs[p, s], det[p, s], expected[p, s], fr[p, s]
+				}
+				printf "\n"
+			}
+		}' $(for name in "$@"; do echo "$WORK/$name.json"; done)
+}
+
+report ${NAMES[@]}
+echo
+report ${LATE_NAMES[@]}
+
+first=1
+echo "[" > "$WORK/all.json"
+for name in ${NAMES[@]} ${LATE_NAMES[@]}
+do
+	[ $first -eq 1 ] || echo "," >> "$WORK/all.json"
+	first=0
+	sed -e '1d' -e '$d' -e 's/"scenario": "/"scenario": "'$name'_/' "$WORK/$name.json" >> "$WORK/all.json"
+done
+echo "]" >> "$WORK/all.json"
+cp "$WORK/all.json" "$OUT"
+echo "wrote $OUT" >&2
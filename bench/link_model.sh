@@ -0,0 +1,86 @@
+#!/bin/bash
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/link_model.sh
+#* About this file: Membership over the link models of EmulNet. Runs one seeded
+#* single failure on a reliable network, then with latency, a bandwidth cap,
+#* bursty loss and a partition that heals, and prints the messages the links
+#* dropped or held back next to the detections and false removals. During the
+#* partition every node on one side removes those on the other, so its false
+#* removals are expected; what matters is how the group recovers.
+#* The statistics of every run are collected into one JSON array.
+#*
+#* Usage: bench/link_model.sh [Application] [output.json]
+#* Environment: NODES (default 200), RUN_TIME (default 500), DETECTOR (default gossip),
+#*              BANDWIDTH (bytes per tick, default 8000), SEED (default 425),
+#*              THREADS (default 1), EXTRA (conf lines added to every run)
+#*
+#***********************
+
+APP=$(realpath "${1:-./Application}")
+OUT=${2:-link.json}
+NODES=${NODES:-200}
+RUN_TIME=${RUN_TIME:-500}
+DETECTOR=${DETECTOR:-gossip}
+BANDWIDTH=${BANDWIDTH:-8000}
+SEED=${SEED:-425}
+THREADS=${THREADS:-1}
+EXTRA=${EXTRA:-}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ ! -x "$APP" ]; then
+	echo "No Application at $APP" >&2
+	exit 1
+fi
+
+# Scenario names and the link parameters of each
+names=(reliable latency bandwidth bursty partition)
+links=(
+	""
+	"LATENCY: 1\nLATENCY_SPREAD: 3\nLATENCY_JITTER: 4\nLATENCY_DIST: exp"
+	"BANDWIDTH: $BANDWIDTH"
+	"LOSS_BURST_ENTER: 0.01\nLOSS_BURST_EXIT: 0.2\nLOSS_BURST_DROP: 0.8"
+	"PARTITION: 150-250:1-$((NODES / 2))"
+)
+
+printf "%-10s %9s %10s %10s %10s %8s %13s %8s %9s\n" "scenario" "wall_sec" "msgs_sent" "dropped" "queued" "wait" "detected" "false" "latency"
+first=1
+echo "[" > "$WORK/all.json"
+rate=$(awk "BEGIN { r = 50.0 / $NODES; print (r < 0.25 ? r : 0.25) }")
+for k in "${!names[@]}"
+do
+	name=${names[$k]}
+	conf="$WORK/$name.conf"
+	printf "MAX_NNB: %d\nSINGLE_FAILURE: 1\nDROP_MSG: 0\nMSG_DROP_PROB: 0\n" $NODES > "$conf"
+	printf "STEP_RATE: %s\nRUN_TIME: %d\nSEED: %d\nTHREADS: %d\nDETECTOR: %s\n" $rate $RUN_TIME $SEED $THREADS $DETECTOR >> "$conf"
+	printf "LOG_FORMAT: none\nVERBOSITY: 0\nPROFILE: %s\n" "$WORK/$name.json" >> "$conf"
+	[ -z "${links[$k]}" ] || printf "%b\n" "${links[$k]}" >> "$conf"
+	[ -z "$EXTRA" ] || printf "%b\n" "$EXTRA" >> "$conf"
+
+	if ! (cd "$WORK" && "$APP" "$conf" > /dev/null); then
+		echo "$name failed" >&2
+		continue
+	fi
+
+	awk -v name=$name -F'[:,]' '
+		/"wall_sec"/ { wall = $2 }
+		/"msgs_sent"/ { msgs = $2 }
+		/"msgs_dropped"/ { dropped = $2 }
+		/"queued_msgs"/ { queued = $2 }
+		/"queue_wait_mean"/ { wait = $2 }
+		/"detections"/ { det = $2 }
+		/"detections_expected"/ { expected = $2 }
+		/"false_removals"/ { fr = $2 }
+		/"detection_latency_mean"/ { lat = $2 }
+		END { printf "%-10s %9.2f %10d %10d %10d %8.2f %6d/%-6d %8d %9.2f\n", name, wall, msgs, dropped, queued, wait, det, expected, fr, lat }' "$WORK/$name.json"
+
+	[ $first -eq 1 ] || echo "," >> "$WORK/all.json"
+	first=0
+	sed -e '1s/^{/{\n  "scenario": "'$name'",/' "$WORK/$name.json" >> "$WORK/all.json"
+done
+echo "]" >> "$WORK/all.json"
+cp "$WORK/all.json" "$OUT"
+echo "wrote $OUT" >&2
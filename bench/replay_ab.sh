@@ -0,0 +1,113 @@
+#!/bin/bash
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/replay_ab.sh
+#* About this file: A/B benchmark on one recorded workload. Records the messages
+#* delivered in one run of the first Application, then replays that trace
+#* REPEAT times with each Application, alternating between them. Both see the
+#* same messages, failures and seed, so the difference in wall time and in the
+#* time of each phase is down to the code. Prints the median of each side and
+#* the change from A to B. The statistics of every replay are collected into
+#* one JSON array.
+#*
+#* Usage: bench/replay_ab.sh [ApplicationA] [ApplicationB] [output.json]
+#* Environment: NODES (default 1000), RUN_TIME (default 300), REPEAT (default 5),
+#*              SEED (default 425), THREADS (default 1), EXTRA (conf lines added to every run)
+#*
+#***********************
+
+APP_A=$(realpath "${1:-./Application}")
+APP_B=$(realpath "${2:-$APP_A}")
+OUT=${3:-replay.json}
+NODES=${NODES:-1000}
+RUN_TIME=${RUN_TIME:-300}
+REPEAT=${REPEAT:-5}
+SEED=${SEED:-425}
+THREADS=${THREADS:-1}
+EXTRA=${EXTRA:-}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+for app in "$APP_A" "$APP_B"
+do
+	if [ ! -x "$app" ]; then
+		echo "No Application at $app" >&2
+		exit 1
+	fi
+done
+
+conf="$WORK/replay.conf"
+rate=$(awk "BEGIN { r = 50.0 / $NODES; print (r < 0.25 ? r : 0.25) }")
+printf "MAX_NNB: %d\nSINGLE_FAILURE: 1\nDROP_MSG: 1\nMSG_DROP_PROB: 0.05\n" $NODES > "$conf"
+printf "STEP_RATE: %s\nRUN_TIME: %d\nTHREADS: %d\nLOG_FORMAT: none\nVERBOSITY: 0\n" $rate $RUN_TIME $THREADS >> "$conf"
+[ -z "$EXTRA" ] || printf "%b\n" "$EXTRA" >> "$conf"
+
+echo "recording $NODES nodes for $RUN_TIME ticks" >&2
+if ! (cd "$WORK" && "$APP_A" "$conf" SEED=$SEED RECORD="$WORK/msgs.trace" > /dev/null); then
+	echo "recording failed" >&2
+	exit 1
+fi
+
+for r in $(seq 1 $REPEAT)
+do
+	for side in A B
+	do
+		app=$APP_A
+		[ $side = A ] || app=$APP_B
+		name="${side}_$r"
+		if ! (cd "$WORK" && "$app" "$conf" REPLAY="$WORK/msgs.trace" PROFILE="$WORK/$name.json" > /dev/null); then
+			echo "replay $name failed" >&2
+			exit 1
+		fi
+	done
+done
+
+printf "%-16s %12s %12s %9s\n" "metric" "A" "B" "change"
+# Median over the replays of each side for every timing
+awk -F'[:,{}]' '
+	function median(side, key,    n, i, j, t, v) {
+		n = 0
+		for (i = 1; i <= runs; i++) {
+			v[++n] = val[side, i, key]
+		}
+		for (i = 2; i <= n; i++) {
+			for (j = i; j > 1 && v[j - 1] > v[j]; j--) {
+				t = v[j]; v[j] = v[j - 1]; v[j - 1] = t
+			}
+		}
+		return n % 2 ? v[(n + 1) / 2] : (v[n / 2] + v[n / 2 + 1]) / 2
+	}
+	FNR == 1 { split(FILENAME, parts, "/"); split(parts[length(parts)], id, "[_.]"); side = id[1]; run = id[2]; if (run > runs) runs = run }
+	/"wall_sec"/ { val[side, run, "wall_sec"] = $2 }
+	/"phase_sec"/ {
+		# Quoted phase names, each followed by its time
+		for (i = 2; i < NF; i++) {
+			if ($i ~ /"/) {
+				key = $i; gsub(/[ "]/, "", key)
+				val[side, run, key] = $(i + 1); keys[key] = 1
+			}
+		}
+	}
+	END {
+		a = median("A", "wall_sec"); b = median("B", "wall_sec")
+		printf "%-16s %12.4f %12.4f %+8.1f%%\n", "wall_sec", a, b, (a > 0 ? 100.0 * (b - a) / a : 0)
+		for (key in keys) {
+			a = median("A", key); b = median("B", key)
+			printf "%-16s %12.4f %12.4f %+8.1f%%\n", key, a, b, (a > 0 ? 100.0 * (b - a) / a : 0)
+		}
+	}' "$WORK"/[AB]_*.json
+
+first=1
+echo "[" > "$WORK/all.json"
+for f in "$WORK"/[AB]_*.json
+do
+	name=$(basename "$f" .json)
+	[ $first -eq 1 ] || echo "," >> "$WORK/all.json"
+	first=0
+	sed -e '1s/^{/{\n  "scenario": "replay_'$name'",/' "$f" >> "$WORK/all.json"
+done
+echo "]" >> "$WORK/all.json"
+cp "$WORK/all.json" "$OUT"
+echo "wrote $OUT" >&2
@@ -0,0 +1,71 @@
+#!/bin/bash
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/scheduler_bench.sh
+#* About this file: Cost of the tick and event schedulers. Runs the same seeded
+#* workload with each detector under both schedulers and prints the wall time
+#* next to the node runs, the times a node was run in a tick. The tick scheduler
+#* runs every node that is up in every tick, the event scheduler only those with
+#* messages or a timer due; both give the same run.
+#* The statistics of every run are collected into one JSON array.
+#*
+#* Usage: bench/scheduler_bench.sh [Application] [output.json]
+#* Environment: NODES (default 1000), RUN_TIME (default 300), DETECTORS (default "gossip swim"),
+#*              SEED (default 425), THREADS (default 1), EXTRA (conf lines added to every run)
+#*
+#***********************
+
+APP=$(realpath "${1:-./Application}")
+OUT=${2:-scheduler.json}
+NODES=${NODES:-1000}
+RUN_TIME=${RUN_TIME:-300}
+DETECTORS=${DETECTORS:-"gossip swim"}
+SEED=${SEED:-425}
+THREADS=${THREADS:-1}
+EXTRA=${EXTRA:-}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ ! -x "$APP" ]; then
+	echo "No Application at $APP" >&2
+	exit 1
+fi
+
+printf "%-8s %-6s %10s %12s %14s %10s %8s\n" "detector" "sched" "wall_sec" "node_runs" "runs/node/t" "msgs_sent" "detected"
+first=1
+echo "[" > "$WORK/all.json"
+rate=$(awk "BEGIN { r = 50.0 / $NODES; print (r < 0.25 ? r : 0.25) }")
+for d in $DETECTORS
+do
+	for s in tick event
+	do
+		name="${d}_$s"
+		conf="$WORK/$name.conf"
+		printf "MAX_NNB: %d\nSINGLE_FAILURE: 1\nDROP_MSG: 1\nMSG_DROP_PROB: 0.05\n" $NODES > "$conf"
+		printf "STEP_RATE: %s\nRUN_TIME: %d\nSEED: %d\nTHREADS: %d\nDETECTOR: %s\nSCHEDULER: %s\n" $rate $RUN_TIME $SEED $THREADS $d $s >> "$conf"
+		printf "LOG_FORMAT: none\nVERBOSITY: 0\nPROFILE: %s\n" "$WORK/$name.json" >> "$conf"
+		[ -z "$EXTRA" ] || printf "%b\n" "$EXTRA" >> "$conf"
+
+		if ! (cd "$WORK" && "$APP" "$conf" > /dev/null); then
+			echo "$name failed" >&2
+			continue
+		fi
+
+		awk -v d=$d -v s=$s -v nodes=$NODES -F'[:,]' '
+			/"ticks"/ { ticks = $2 }
+			/"wall_sec"/ { wall = $2 }
+			/"node_runs"/ { runs = $2 }
+			/"msgs_sent"/ { msgs = $2 }
+			/"detections"/ { det = $2 }
+			END { printf "%-8s %-6s %10.2f %12d %14.3f %10d %8d\n", d, s, wall, runs, runs / nodes / ticks, msgs, det }' "$WORK/$name.json"
+
+		[ $first -eq 1 ] || echo "," >> "$WORK/all.json"
+		first=0
+		sed -e '1s/^{/{\n  "scenario": "'$name'",/' "$WORK/$name.json" >> "$WORK/all.json"
+	done
+done
+echo "]" >> "$WORK/all.json"
+cp "$WORK/all.json" "$OUT"
+echo "wrote $OUT" >&2
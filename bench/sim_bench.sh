@@ -0,0 +1,67 @@
+#!/bin/bash
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/sim_bench.sh
+#* About this file: Simulation throughput benchmark. Generates scenarios for a
+#* range of group sizes, failure patterns and drop probabilities, runs each one
+#* headless with PROFILE on and collects the per run statistics into one JSON
+#* array that can be diffed between commits.
+#*
+#* Usage: bench/sim_bench.sh [Application] [output.json]
+#* Environment: SIZES (default "10 100 1000 10000"), THREADS (default 1),
+#*              RUN_TIME (default 300), SEED (default 425), DROPS (default "0 0.1"),
+#*              EXTRA (conf lines added to every scenario, e.g. "DETECTOR: swim")
+#*
+#***********************
+
+APP=$(realpath "${1:-./Application}")
+OUT=${2:-bench.json}
+SIZES=${SIZES:-"10 100 1000 10000"}
+THREADS=${THREADS:-1}
+RUN_TIME=${RUN_TIME:-300}
+SEED=${SEED:-425}
+EXTRA=${EXTRA:-}
+DROPS=${DROPS:-"0 0.1"}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ ! -x "$APP" ]; then
+	echo "No Application at $APP" >&2
+	exit 1
+fi
+
+first=1
+echo "[" > "$WORK/all.json"
+for n in $SIZES
+do
+	# Everyone has joined well before the failures at tick 100
+	rate=$(awk "BEGIN { r = 50.0 / $n; print (r < 0.25 ? r : 0.25) }")
+	for single in 1 0
+	do
+		for drop in $DROPS
+		do
+			name="n${n}_$([ $single -eq 1 ] && echo single || echo multi)_drop${drop}"
+			conf="$WORK/$name.conf"
+			dropmsg=$([ "$drop" == "0" ] && echo 0 || echo 1)
+			printf "MAX_NNB: %d\nSINGLE_FAILURE: %d\nDROP_MSG: %d\nMSG_DROP_PROB: %s\n" $n $single $dropmsg $drop > "$conf"
+			printf "STEP_RATE: %s\nRUN_TIME: %d\nSEED: %d\nTHREADS: %d\n" $rate $RUN_TIME $SEED $THREADS >> "$conf"
+			printf "LOG_FORMAT: none\nVERBOSITY: 0\nPROFILE: %s\n" "$WORK/$name.json" >> "$conf"
+			[ -z "$EXTRA" ] || printf "%b\n" "$EXTRA" >> "$conf"
+
+			echo "running $name" >&2
+			if ! (cd "$WORK" && "$APP" "$conf" > /dev/null); then
+				echo "$name failed" >&2
+				continue
+			fi
+
+			[ $first -eq 1 ] || echo "," >> "$WORK/all.json"
+			first=0
+			sed -e '1s/^{/{\n  "scenario": "'$name'",/' "$WORK/$name.json" >> "$WORK/all.json"
+		done
+	done
+done
+echo "]" >> "$WORK/all.json"
+cp "$WORK/all.json" "$OUT"
+echo "wrote $OUT" >&2
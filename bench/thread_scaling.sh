@@ -0,0 +1,47 @@
+#!/bin/bash
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/thread_scaling.sh
+#* About this file: Runs one large group with 1..N simulation threads and reports
+#* the wall time of each run. With a fixed SEED every run must produce the same
+#* dbg.log, which is checked as well: the script fails if any run differs.
+#*
+#* Usage: bench/thread_scaling.sh [Application] [nodes] [max threads]
+#*
+#***********************
+
+APP=$(realpath "${1:-./Application}")
+NODES=${2:-1000}
+MAXTHREADS=${3:-$(nproc)}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+printf "%8s %8s %10s %8s %s\n" "nodes" "threads" "wall_ms" "speedup" "dbg.log"
+base=0
+ref=""
+status=0
+for (( t = 1; t <= MAXTHREADS; t++ ))
+do
+	conf="$WORK/scale$t.conf"
+	printf "MAX_NNB: %d\nSINGLE_FAILURE: 0\nDROP_MSG: 1\nMSG_DROP_PROB: 0.1\nSEED: 425\nTHREADS: %d\n" $NODES $t > "$conf"
+	start=$(date +%s%N)
+	(cd "$WORK" && "$APP" "$conf" >/dev/null)
+	end=$(date +%s%N)
+	ms=$(( (end - start) / 1000000 ))
+	sum=$(md5sum "$WORK/dbg.log" | cut -d' ' -f1)
+	if [ $t -eq 1 ]; then
+		base=$ms
+		ref=$sum
+	fi
+	if [ "$sum" == "$ref" ]; then
+		same="identical"
+	else
+		same="DIFFERS"
+		status=1
+	fi
+	printf "%8d %8d %10d %8s %s\n" $NODES $t $ms $(awk "BEGIN { printf \"%.2f\", $base / ($ms > 0 ? $ms : 1) }") $same
+done
+
+exit $status
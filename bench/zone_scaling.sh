@@ -0,0 +1,83 @@
+#!/bin/bash
+#**********************
+#*
+#* Progam Name: MP1. Membership Protocol.
+#*
+#* Current file: bench/zone_scaling.sh
+#* About this file: Scaling benchmark of the hierarchical mode. Runs a single
+#* failure at each group size, once with one flat group and once split into
+#* zones of about sqrt(N) ids, and prints the membership memory and the
+#* messages per node next to the detections and false removals. Flat groups
+#* cost O(N) memory per node and are only run up to FLAT_MAX nodes.
+#* The statistics of every run are collected into one JSON array.
+#*
+#* Usage: bench/zone_scaling.sh [Application] [output.json]
+#* Environment: SIZES (default "1000 10000"; 100000 takes about 5.5 GB and 15 minutes),
+#*              FLAT_MAX (default 10000),
+#*              ZONE (ids per zone, default sqrt of the size), RUN_TIME (default 200),
+#*              SEED (default 425), THREADS (default 1), EXTRA (conf lines added to every run)
+#*
+#***********************
+
+APP=$(realpath "${1:-./Application}")
+OUT=${2:-zones.json}
+SIZES=${SIZES:-"1000 10000"}
+FLAT_MAX=${FLAT_MAX:-10000}
+RUN_TIME=${RUN_TIME:-200}
+SEED=${SEED:-425}
+THREADS=${THREADS:-1}
+EXTRA=${EXTRA:-}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ ! -x "$APP" ]; then
+	echo "No Application at $APP" >&2
+	exit 1
+fi
+
+printf "%8s %6s %10s %14s %12s %10s %12s %13s %8s %11s\n" "nodes" "zone" "wall_sec" "table_B/node" "msgs/node/t" "max_msg_B" "peak_rss_kb" "detected" "false" "zones_known"
+first=1
+echo "[" > "$WORK/all.json"
+for n in $SIZES
+do
+	zone=${ZONE:-$(awk "BEGIN { print int(sqrt($n) + 0.5) }")}
+	# Everyone has joined well before the failure at tick 100
+	rate=$(awk "BEGIN { r = 50.0 / $n; print (r < 0.25 ? r : 0.25) }")
+	for z in 0 $zone
+	do
+		if [ $z -eq 0 ] && [ $n -gt $FLAT_MAX ]; then
+			continue
+		fi
+		name="n${n}_zone${z}"
+		conf="$WORK/$name.conf"
+		printf "MAX_NNB: %d\nSINGLE_FAILURE: 1\nDROP_MSG: 0\nMSG_DROP_PROB: 0\n" $n > "$conf"
+		printf "STEP_RATE: %s\nRUN_TIME: %d\nSEED: %d\nTHREADS: %d\nZONE_SIZE: %d\n" $rate $RUN_TIME $SEED $THREADS $z >> "$conf"
+		printf "LOG_FORMAT: none\nVERBOSITY: 0\nPROFILE: %s\n" "$WORK/$name.json" >> "$conf"
+		[ -z "$EXTRA" ] || printf "%b\n" "$EXTRA" >> "$conf"
+
+		if ! (cd "$WORK" && "$APP" "$conf" > /dev/null); then
+			echo "$name failed" >&2
+			continue
+		fi
+
+		awk -v nodes=$n -v zone=$z -F'[:,]' '
+			/"ticks"/ { ticks = $2 }
+			/"wall_sec"/ { wall = $2 }
+			/"msgs_sent"/ { msgs = $2 }
+			/"max_msg_bytes"/ { msg = $2 }
+			/"member_table_bytes"/ { table = $2 }
+			/"peak_rss_kb"/ { rss = $2 }
+			/"detections"/ { det = $2 }
+			/"detections_expected"/ { expected = $2 }
+			/"false_removals"/ { fr = $2 }
+			/"zones_known_min"/ { known = $2 }
+			END { printf "%8d %6d %10.2f %14d %12.3f %10d %12d %6d/%-6d %8d %11d\n", nodes, zone, wall, table / nodes, msgs / nodes / ticks, msg, rss, det, expected, fr, known }' "$WORK/$name.json"
+
+		[ $first -eq 1 ] || echo "," >> "$WORK/all.json"
+		first=0
+		sed -e '1s/^{/{\n  "scenario": "'$name'",/' "$WORK/$name.json" >> "$WORK/all.json"
+	done
+done
+echo "]" >> "$WORK/all.json"
+cp "$WORK/all.json" "$OUT"
+echo "wrote $OUT" >&2
@@ -18,6 +18,9 @@
  * Standard Header files
  */
 #include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stddef.h>
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
@@ -31,6 +34,7 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <algorithm>
 #include <queue>
@@ -40,6 +44,10 @@ using namespace std;
 
 #define STDCLLBKARGS (void *env, char *data, int size)
 #define STDCLLBKRET	void
+// dbg.log lines beyond joins and removals, such as node failures which Grader.sh needs.
+// Build with -DNO_DEBUGLOG to leave them out.
+#ifndef NO_DEBUGLOG
 #define DEBUGLOG 1
+#endif
 		
 #endif	/* _STDINCLUDES_H_ */
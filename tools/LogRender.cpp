@@ -0,0 +1,39 @@
+/**********************************
+ * FILE NAME: LogRender.cpp
+ *
+ * DESCRIPTION: Renders a binary log written with LOG_FORMAT: binary into the
+ * 				dbg.log and stats.log text a text mode run writes
+ *
+ * Usage: LogRender [dbg.bin [dbg.log [stats.log]]]
+ **********************************/
+
+#include "../BinLog.h"
+#include "../Log.h"
+
+int main(int argc, char *argv[]) {
+	const char *bin = argc > 1 ? argv[1] : DBG_BIN;
+	const char *dbgName = argc > 2 ? argv[2] : DBG_LOG;
+	const char *statsName = argc > 3 ? argv[3] : STATS_LOG;
+
+	FILE *in = fopen(bin, "rb");
+	if ( in == NULL ) {
+		fprintf(stderr, "Cannot open %s\n", bin);
+		return FAILURE;
+	}
+	FILE *dbg = fopen(dbgName, "w");
+	FILE *stats = fopen(statsName, "w");
+	if ( dbg == NULL || stats == NULL ) {
+		fprintf(stderr, "Cannot write %s or %s\n", dbgName, statsName);
+		return FAILURE;
+	}
+
+	int lines = BinLogWriter::render(in, dbg, stats, MAGIC_NUMBER);
+	fclose(in);
+	fclose(dbg);
+	fclose(stats);
+	if ( lines < 0 ) {
+		fprintf(stderr, "%s is not a binary log\n", bin);
+		return FAILURE;
+	}
+	return SUCCESS;
+}